@@ -46,9 +46,9 @@ void setup() {
 	// Reset default power-on register settings
 	keyDriver.resetRegisterDefaults();
 
-	// The power-on default is inexplicably to use COL2 - COL7 and GPO.
-	// Disable GPO on the COL pins so the 4x3 key matrix will work on COL2.
-	keyDriver.setGpoEnable(MAX7360::REG_GPO_DISABLED);
+	// The power-on default is COL2 - COL7 as GPO, which leaves only COL0 and COL1 for keys.
+	// Scan only the columns used by the key mapping (COL0 - COL2 for the 4x3 keypad).
+	keyDriver.configureForKeyMapping();
 
 	// Only generate key down events, not key up
 	keyDriver.setConfigurationEnableKeyRelease(false);
@@ -0,0 +1,82 @@
+#include "MAX7360-RK.h"
+
+// Compares FIFO drain and LED frame throughput at 100 kHz and 400 kHz I2C.
+// Results are printed to USB serial. Nothing needs to be pressed.
+
+SYSTEM_THREAD(ENABLED);
+
+SYSTEM_MODE(MANUAL);
+
+SerialLogHandler logHandler;
+
+MAX7360 keyDriver(0x38);
+
+const size_t NUM_ITERATIONS = 1000;
+
+void runBenchmark(uint32_t speed);
+
+void setup() {
+	waitFor(Serial.isConnected, 15000);
+	delay(1000);
+
+	runBenchmark(CLOCK_SPEED_100KHZ);
+	runBenchmark(CLOCK_SPEED_400KHZ);
+}
+
+void loop() {
+}
+
+void runBenchmark(uint32_t speed) {
+	// The speed can only be changed before the bus is started
+	Wire.end();
+
+	keyDriver.withBusSpeed(speed);
+	if (!keyDriver.begin()) {
+		Log.error("chip not responding");
+		return;
+	}
+	if (keyDriver.getBusSpeed() != speed) {
+		Log.info("speed %lu not supported, fell back to %lu", (unsigned long) speed, (unsigned long) keyDriver.getBusSpeed());
+		return;
+	}
+
+	keyDriver.resetRegisterDefaults();
+	keyDriver.setConfigEnableGpio();
+	keyDriver.setGpioInputOutputMode(0b111);
+
+	// FIFO drain: one single-byte register read per key
+	unsigned long start = micros();
+	for(size_t ii = 0; ii < NUM_ITERATIONS; ii++) {
+		keyDriver.readKeyFIFO();
+	}
+	unsigned long fifoUs = micros() - start;
+
+	// LED frame, three separate writes (PORT0 - PORT2)
+	start = micros();
+	for(size_t ii = 0; ii < NUM_ITERATIONS; ii++) {
+		uint8_t value = (uint8_t) ii;
+		keyDriver.setPortPwmRatio(0, value);
+		keyDriver.setPortPwmRatio(1, value);
+		keyDriver.setPortPwmRatio(2, value);
+	}
+	unsigned long singleUs = micros() - start;
+
+	// LED frame, one burst write
+	start = micros();
+	for(size_t ii = 0; ii < NUM_ITERATIONS; ii++) {
+		uint8_t values[3] = { (uint8_t) ii, (uint8_t) ii, (uint8_t) ii };
+		keyDriver.writeRegisters(MAX7360::REG_PORT_PWM_RATIO, values, sizeof(values));
+	}
+	unsigned long burstUs = micros() - start;
+
+	Log.info("speed=%lu fifoRead=%lu us fifoReadsPerSec=%lu", (unsigned long) speed,
+		fifoUs / NUM_ITERATIONS, (unsigned long)(NUM_ITERATIONS * 1000000ULL / fifoUs));
+	Log.info("speed=%lu ledFrame3Writes=%lu us framesPerSec=%lu", (unsigned long) speed,
+		singleUs / NUM_ITERATIONS, (unsigned long)(NUM_ITERATIONS * 1000000ULL / singleUs));
+	Log.info("speed=%lu ledFrameBurst=%lu us framesPerSec=%lu", (unsigned long) speed,
+		burstUs / NUM_ITERATIONS, (unsigned long)(NUM_ITERATIONS * 1000000ULL / burstUs));
+
+	keyDriver.setPortPwmRatio(0, 0);
+	keyDriver.setPortPwmRatio(1, 0);
+	keyDriver.setPortPwmRatio(2, 0);
+}
@@ -2,6 +2,10 @@
 // License: MIT
 
 #include "MAX7360-RK.h"
+#if MAX7360_ENABLE_INSTRUMENTATION
+#include "MAX7360Trace.h"
+#include "MAX7360Latency.h"
+#endif
 
 
 
@@ -19,9 +23,45 @@ MAX7360::~MAX7360() {
 
 bool MAX7360::begin() {
 	// Initialize the I2C bus in standard master mode.
+	wire.setSpeed(busSpeed);
 	wire.begin();
 
-	return true;
+	if (busSpeed == CLOCK_SPEED_100KHZ) {
+		return true;
+	}
+
+	if (checkBus()) {
+		return true;
+	}
+
+	// Fast mode didn't work (bus capacitance too high, or another device can't handle it).
+	// Fall back to standard mode.
+	Log.info("MAX7360 bus check failed at %lu Hz, using 100 kHz", (unsigned long) busSpeed);
+	busSpeed = CLOCK_SPEED_100KHZ;
+	wire.end();
+	wire.setSpeed(busSpeed);
+	wire.begin();
+
+	return checkBus();
+}
+
+bool MAX7360::checkBus() {
+	const uint8_t reg = REG_PORT_PWM_RATIO + 7;
+	const uint8_t testValues[2] = { 0xa5, 0x5a };
+	bool result = true;
+
+	uint8_t original = readRegister(reg);
+
+	for(size_t ii = 0; ii < sizeof(testValues); ii++) {
+		if (!writeRegister(reg, testValues[ii]) || readRegister(reg) != testValues[ii]) {
+			result = false;
+			break;
+		}
+	}
+
+	writeRegister(reg, original);
+
+	return result;
 }
 
 
@@ -45,12 +85,97 @@ bool MAX7360::resetRegisterDefaults() {
 }
 
 
+bool MAX7360::snapshot(MAX7360Snapshot &snapshot) {
+	bool result = readRegisters(MAX7360Snapshot::LOW_FIRST, snapshot.low, MAX7360Snapshot::LOW_COUNT);
+
+	// Read around 0x48 - 0x4a. Reading the I2C timeout flag and rotary switch count clears them,
+	// and reading the GPIO inputs clears the port interrupt.
+	const size_t firstCount = REG_I2C_TIMEOUT_FLAG - MAX7360Snapshot::GPIO_FIRST;
+	result = readRegisters(MAX7360Snapshot::GPIO_FIRST, snapshot.gpio, firstCount) && result;
+
+	memset(&snapshot.gpio[firstCount], 0, REG_GPIO_ROTARY_SWITCH_COUNT - REG_I2C_TIMEOUT_FLAG + 1);
+
+	const size_t secondIndex = REG_GPIO_ROTARY_SWITCH_COUNT + 1 - MAX7360Snapshot::GPIO_FIRST;
+	return readRegisters(REG_GPIO_ROTARY_SWITCH_COUNT + 1, &snapshot.gpio[secondIndex], MAX7360Snapshot::GPIO_COUNT - secondIndex) && result;
+}
+
+bool MAX7360::restore(const MAX7360Snapshot &snapshot) {
+	bool result = writeRegisters(MAX7360Snapshot::LOW_FIRST, snapshot.low, MAX7360Snapshot::LOW_COUNT);
+
+	// 0x40 - 0x46. Don't set the reset bit, it would reset everything we're writing.
+	uint8_t gpioConfig[REG_ROTARY_SWITCH_CONFIG - REG_GPIO_CONFIG + 1];
+	memcpy(gpioConfig, snapshot.gpio, sizeof(gpioConfig));
+	gpioConfig[0] &= ~REG_GPIO_CONFIG_RESET_MASK;
+	result = writeRegisters(REG_GPIO_CONFIG, gpioConfig, sizeof(gpioConfig)) && result;
+
+	// 0x50 - 0x5f (skips read-only 0x48 - 0x4a and non-existent 0x47, 0x4b - 0x4f)
+	result = writeRegisters(REG_PORT_PWM_RATIO, &snapshot.gpio[REG_PORT_PWM_RATIO - REG_GPIO_CONFIG], 16) && result;
+
+	return result;
+}
+
+
 MAX7360Key MAX7360::readKeyFIFO() {
-	MAX7360Key result(keyMapping, readRegister(REG_KEYS_FIFO));
+#if MAX7360_ENABLE_INSTRUMENTATION
+	unsigned long readStartUs = latencyMonitor ? micros() : 0;
+#endif
+
+	MAX7360Key result(keyMapping, readFifoRaw());
+
+#if MAX7360_ENABLE_KEYPAD
+	if (repeatCoalescing && result.getRawValue() == MAX7360Key::FIFO_KEY_REPEAT_MORE) {
+		// Read ahead while there are more repeats. The FIFO only holds 16 entries.
+		uint16_t repeatCount = 1;
+		for(size_t ii = 0; ii < 16; ii++) {
+			uint8_t next = readFifoRaw();
+			if (next == MAX7360Key::FIFO_KEY_REPEAT_MORE || next == MAX7360Key::FIFO_KEY_REPEAT_DONE) {
+				repeatCount++;
+				result.fromRawValue(next);
+				if (next == MAX7360Key::FIFO_KEY_REPEAT_DONE) {
+					break;
+				}
+			}
+			else {
+				// Not a repeat; return it on the next call
+				if (next != MAX7360Key::FIFO_EMPTY) {
+					readAhead = next;
+					hasReadAhead = true;
+				}
+				break;
+			}
+		}
+		result.setRepeatCount(repeatCount);
+	}
+#endif
+
+#if MAX7360_ENABLE_INSTRUMENTATION
+	if (latencyMonitor && !result.isEmpty()) {
+		latencyMonitor->markFifoRead(readStartUs, micros());
+	}
+#endif
 
 	return result;
 }
 
+uint8_t MAX7360::readFifoRaw() {
+#if MAX7360_ENABLE_KEYPAD
+	if (hasReadAhead) {
+		hasReadAhead = false;
+		return readAhead;
+	}
+#endif
+
+	uint8_t value = readRegister(REG_KEYS_FIFO);
+
+#if MAX7360_ENABLE_INSTRUMENTATION
+	if (traceRecorder) {
+		traceRecorder->recordFifo(value);
+	}
+#endif
+
+	return value;
+}
+
 
 uint8_t MAX7360::getConfiguration() {
 	return readRegister(REG_CONFIG);
@@ -81,6 +206,35 @@ bool MAX7360::setConfigurationDisableI2CTimeouts(bool value) {
 
 
 
+bool MAX7360::setAutoRepeat(bool enable, uint8_t delayCode, uint8_t rateCode) {
+	uint8_t value = 0;
+
+	if (enable) {
+		value = REG_AUTO_REPEAT_ENABLE_MASK;
+		value |= (rateCode << REG_AUTO_REPEAT_RATE_SHIFT) & REG_AUTO_REPEAT_RATE_MASK;
+		value |= delayCode & REG_AUTO_REPEAT_DELAY_MASK;
+	}
+
+	return writeRegister(REG_AUTO_REPEAT, value);
+}
+
+bool MAX7360::setAutoRepeatMs(unsigned int delayMs, unsigned int rateMs) {
+	if (delayMs == 0) {
+		return setAutoRepeat(false);
+	}
+
+	unsigned int debounceMs = getDebounceTimeMs();
+
+	// Round to the nearest number of 8 debounce cycle (delay) or 4 debounce cycle (rate) units
+	unsigned int delayUnits = (delayMs + debounceMs * 4) / (debounceMs * 8);
+	unsigned int rateUnits = (rateMs + debounceMs * 2) / (debounceMs * 4);
+
+	uint8_t delayCode = (delayUnits > 16) ? 15 : ((delayUnits > 0) ? (delayUnits - 1) : 0);
+	uint8_t rateCode = (rateUnits > 8) ? 7 : ((rateUnits > 0) ? (rateUnits - 1) : 0);
+
+	return setAutoRepeat(true, delayCode, rateCode);
+}
+
 uint8_t MAX7360::getDebounceTimeMs() {
 	return (readRegister(REG_DEBOUNCE) & REG_DEBOUNCE_MASK) + REG_DEBOUNCE_MS_OFFSET;
 }
@@ -110,6 +264,66 @@ bool MAX7360::setGpoEnable(uint8_t value) {
 	return setRegisterMask(REG_DEBOUNCE, ~REG_GPO_ENABLE_MASK, value);
 }
 
+#if MAX7360_ENABLE_KEYPAD
+bool MAX7360::configureForKeyMapping() {
+	if (!keyMapping) {
+		return false;
+	}
+
+	uint8_t colMask = keyMapping->getUsedColumnMask();
+
+	uint8_t numCols = 0;
+	while(colMask >> numCols) {
+		numCols++;
+	}
+	if (numCols < 2) {
+		// COL0 and COL1 can't be GPO
+		numCols = 2;
+	}
+
+	return setGpoEnable((8 - numCols) << 5);
+}
+#endif /* MAX7360_ENABLE_KEYPAD */
+
+#if MAX7360_ENABLE_GPIO
+bool MAX7360::writeGpoOutputs(uint8_t mask, uint8_t values) {
+	lockBus();
+
+	uint8_t oldValue = getGpoShadow();
+	uint8_t newValue = (oldValue & ~mask) | (values & mask);
+
+	bool result = true;
+	if (newValue != oldValue) {
+		result = writeRegister(REG_GPO_CONTROL, newValue);
+	}
+
+	unlockBus();
+
+	return result;
+}
+
+bool MAX7360::toggleGpoOutputs(uint8_t mask) {
+	lockBus();
+
+	bool result = writeRegister(REG_GPO_CONTROL, getGpoShadow() ^ mask);
+
+	unlockBus();
+
+	return result;
+}
+
+uint8_t MAX7360::getGpoOutputs() {
+	return getGpoShadow();
+}
+
+uint8_t MAX7360::getGpoShadow() {
+	uint8_t value;
+	if (!getCachedRegister(REG_GPO_CONTROL, value)) {
+		value = readRegister(REG_GPO_CONTROL);
+	}
+	return value;
+}
+
 
 bool MAX7360::setPortInterrupt(uint8_t port, bool enabled, bool risingAndFalling) {
 
@@ -126,21 +340,58 @@ bool MAX7360::setPortInterrupt(uint8_t port, bool enabled, bool risingAndFalling
 	return setRegisterMask(REG_PORT_CONFIG + port, ~mask, value);
 }
 
+uint8_t MAX7360::readGpioInputs() {
+	uint8_t value = readRegister(REG_GPIO_INPUT);
+
+#if MAX7360_ENABLE_INSTRUMENTATION
+	if (traceRecorder) {
+		traceRecorder->recordGpio(value);
+	}
+#endif
+
+	return value;
+}
+#endif /* MAX7360_ENABLE_GPIO */
+
+#if MAX7360_ENABLE_ROTARY
+int8_t MAX7360::readRotarySwitchCount() {
+	int8_t value = (int8_t) readRegister(REG_GPIO_ROTARY_SWITCH_COUNT);
+
+#if MAX7360_ENABLE_INSTRUMENTATION
+	if (traceRecorder) {
+		traceRecorder->recordRotary(value);
+	}
+#endif
+
+	return value;
+}
+#endif /* MAX7360_ENABLE_ROTARY */
+
 
 uint8_t MAX7360::readRegister(uint8_t reg) {
+	lockBus();
+
 	wire.beginTransmission(addr);
 	wire.write(reg);
 	wire.endTransmission(false);
 
-	wire.requestFrom(addr, (uint8_t) 1, (uint8_t) true);
+	size_t numRead = wire.requestFrom(addr, (uint8_t) 1, (uint8_t) true);
 	uint8_t value = (uint8_t) wire.read();
 
+	// Update the cache before unlocking so another thread can't write the register in between
+	if (numRead == 1) {
+		updateCache(reg, &value, 1, false);
+	}
+
+	unlockBus();
+
 	// Log.trace("readRegister reg=%d value=%d", reg, value);
 
 	return value;
 }
 
 bool MAX7360::writeRegister(uint8_t reg, uint8_t value) {
+	lockBus();
 
 	wire.beginTransmission(addr);
 	wire.write(reg);
@@ -148,19 +399,167 @@ bool MAX7360::writeRegister(uint8_t reg, uint8_t value) {
 
 	int stat = wire.endTransmission(true);
 
+	if (stat == 0) {
+		updateCache(reg, &value, 1, true);
+	}
+
+	unlockBus();
+
 	// Log.trace("writeRegister reg=%d value=%d stat=%d read=%d", reg, value, stat, readRegister(reg));
 
 	return (stat == 0);
 }
 
 
+bool MAX7360::readRegisters(uint8_t reg, uint8_t *values, size_t count) {
+	if (count == 0 || count > I2C_BUFFER_SIZE) {
+		return false;
+	}
+
+	lockBus();
+
+	wire.beginTransmission(addr);
+	wire.write(reg);
+	wire.endTransmission(false);
+
+	size_t numRead = wire.requestFrom(addr, (uint8_t) count, (uint8_t) true);
+	for(size_t ii = 0; ii < count; ii++) {
+		values[ii] = (uint8_t) wire.read();
+	}
+
+	if (numRead == count) {
+		updateCache(reg, values, count, false);
+	}
+
+	unlockBus();
+
+	return (numRead == count);
+}
+
+bool MAX7360::writeRegisters(uint8_t reg, const uint8_t *values, size_t count) {
+	if (count == 0 || count >= I2C_BUFFER_SIZE) {
+		return false;
+	}
+
+	lockBus();
+
+	wire.beginTransmission(addr);
+	wire.write(reg);
+	wire.write(values, count);
+
+	int stat = wire.endTransmission(true);
+
+	if (stat == 0) {
+		updateCache(reg, values, count, true);
+	}
+
+	unlockBus();
+
+	return (stat == 0);
+}
+
+
 bool MAX7360::setRegisterMask(uint8_t reg, uint8_t andValue, uint8_t orValue) {
+	// Hold the bus across the read and write so another thread can't change the register in between.
+	// The lock is recursive, so readRegister and writeRegister can lock it again.
+	lockBus();
+
 	uint8_t rawValue = readRegister(reg);
 
 	rawValue &= andValue;
 	rawValue |= orValue;
 
-	return writeRegister(reg, rawValue);
+	bool result = writeRegister(reg, rawValue);
+
+	unlockBus();
+
+	return result;
+}
+
+bool MAX7360::getCachedRegister(uint8_t reg, uint8_t &value) const {
+	int index = cacheIndex(reg);
+	if (index < 0 || (cacheValid[index / 32] & (1UL << (index % 32))) == 0) {
+		return false;
+	}
+	value = cache[index];
+	return true;
+}
+
+void MAX7360::invalidateCache() {
+	lockBus();
+	cacheValid[0] = cacheValid[1] = 0;
+	unlockBus();
+}
+
+#if MAX7360_ENABLE_INSTRUMENTATION
+void MAX7360::resetLockStats() {
+	memset(&lockStats, 0, sizeof(lockStats));
+}
+#endif /* MAX7360_ENABLE_INSTRUMENTATION */
+
+// [static]
+int MAX7360::cacheIndex(uint8_t reg) {
+	if (reg >= MAX7360Snapshot::LOW_FIRST && reg < MAX7360Snapshot::LOW_FIRST + MAX7360Snapshot::LOW_COUNT) {
+		return reg - MAX7360Snapshot::LOW_FIRST;
+	}
+	if (reg >= MAX7360Snapshot::GPIO_FIRST && reg < MAX7360Snapshot::GPIO_FIRST + MAX7360Snapshot::GPIO_COUNT) {
+		return (int)MAX7360Snapshot::LOW_COUNT + reg - MAX7360Snapshot::GPIO_FIRST;
+	}
+	return -1;
+}
+
+void MAX7360::updateCache(uint8_t reg, const uint8_t *values, size_t count, bool isWrite) {
+	for(size_t ii = 0; ii < count; ii++) {
+		uint8_t r = reg + ii;
+		if (r == REG_I2C_TIMEOUT_FLAG || r == REG_GPIO_ROTARY_SWITCH_COUNT) {
+			// Reading these clears them, the cached value would be meaningless
+			continue;
+		}
+		int index = cacheIndex(r);
+		if (index >= 0) {
+			cache[index] = values[ii];
+			cacheValid[index / 32] |= (1UL << (index % 32));
+		}
+	}
+
+	if (isWrite && reg <= REG_GPIO_CONFIG && reg + count > REG_GPIO_CONFIG) {
+		if (values[REG_GPIO_CONFIG - reg] & REG_GPIO_CONFIG_RESET_MASK) {
+			// GPIO reset sets 0x40 - 0x5f to defaults
+			for(size_t ii = 0; ii < MAX7360Snapshot::GPIO_COUNT; ii++) {
+				size_t index = MAX7360Snapshot::LOW_COUNT + ii;
+				cacheValid[index / 32] &= ~(1UL << (index % 32));
+			}
+		}
+	}
+}
+
+void MAX7360::lockBus() {
+	if (!threadSafe) {
+		return;
+	}
+#if MAX7360_ENABLE_INSTRUMENTATION
+	unsigned long startUs = micros();
+	wire.lock();
+	uint32_t waitUs = (uint32_t)(micros() - startUs);
+
+	// Only the holder of the lock updates the stats
+	lockStats.lockCount++;
+	lockStats.totalWaitUs += waitUs;
+	if (waitUs >= LOCK_CONTENDED_US) {
+		lockStats.contendedCount++;
+	}
+	if (waitUs > lockStats.maxWaitUs) {
+		lockStats.maxWaitUs = waitUs;
+	}
+#else
+	wire.lock();
+#endif
+}
+
+void MAX7360::unlockBus() {
+	if (threadSafe) {
+		wire.unlock();
+	}
 }
 
 bool MAX7360::setRegisterBitmask(uint8_t reg, uint8_t bitMask, bool set) {
@@ -182,6 +581,7 @@ MAX7360Key::MAX7360Key(MAX7360KeyMappingBase *keyMapping, uint8_t rawValue) : ke
 
 void MAX7360Key::fromRawValue(uint8_t rawValue) {
 	this->rawValue = rawValue;
+	repeatCount = isKeyRepeat() ? 1 : 0;
 
 	switch(rawValue) {
 	case FIFO_EMPTY:
@@ -258,6 +658,17 @@ MAX7360KeyMappingBase::MAX7360KeyMappingBase() {
 MAX7360KeyMappingBase::~MAX7360KeyMappingBase() {
 }
 
+#if MAX7360_ENABLE_KEYPAD
+uint8_t MAX7360KeyMappingBase::getUsedColumnMask() {
+	uint8_t mask = 0;
+	for(uint8_t rawKey = 0; rawKey < 64; rawKey++) {
+		if (rawToReadable(rawKey)) {
+			mask |= 1 << (rawKey >> 3);
+		}
+	}
+	return mask;
+}
+
 MAX7360KeyMappingTable::MAX7360KeyMappingTable(const char *table, size_t tableSize) : table(table), tableSize(tableSize) {
 
 }
@@ -285,7 +696,7 @@ uint8_t MAX7360KeyMappingTable::readableToRaw(char c) {
 
 static const char _phoneTable[24] = {
 	'1', '4', '7', '*',   0,   0,   0,   0,
-	'2', '5', '9', '0',   0,   0,   0,   0,
+	'2', '5', '8', '0',   0,   0,   0,   0,
 	'3', '6', '9', '#',   0,   0,   0,   0
 };
 
@@ -294,5 +705,4 @@ MAX7360KeyMappingPhone::MAX7360KeyMappingPhone() : MAX7360KeyMappingTable(_phone
 
 MAX7360KeyMappingPhone::~MAX7360KeyMappingPhone() {
 }
-	
-
+#endif /* MAX7360_ENABLE_KEYPAD */
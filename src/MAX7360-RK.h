@@ -5,9 +5,12 @@
 // License: MIT
 
 #include "Particle.h"
+#include "MAX7360Config.h"
 
 
 class MAX7360KeyMappingBase; // Forward declaration
+class MAX7360TraceRecorder; // Forward declaration
+class MAX7360LatencyMonitor; // Forward declaration
 
 class MAX7360Key {
 public:
@@ -26,6 +29,20 @@ public:
 	bool isReleased() const { return released; };
 	bool isKeyRepeat() const { return rawValue == FIFO_KEY_REPEAT_MORE || rawValue == FIFO_KEY_REPEAT_DONE; };
 
+	/**
+	 * @brief Number of auto-repeats this event represents
+	 * 
+	 * This is 1 for a repeat code and 0 for anything else, unless repeat coalescing is enabled
+	 * (MAX7360::withRepeatCoalescing), in which case consecutive repeat codes are combined into
+	 * one event with the total count.
+	 */
+	uint16_t getRepeatCount() const { return repeatCount; };
+
+	/**
+	 * @brief Sets the repeat count. Used when coalescing repeat codes.
+	 */
+	void setRepeatCount(uint16_t repeatCount) { this->repeatCount = repeatCount; };
+
 	static const uint8_t FIFO_EMPTY 			= 0b00111111;
 	static const uint8_t FIFO_OVERFLOW 			= 0b01111111;
 	static const uint8_t FIFO_KEY63_PRESSED 	= 0b10111111;
@@ -47,6 +64,7 @@ protected:
 	uint8_t rawKey = FIFO_KEY_NONE;
 	bool more = false;
 	bool released = false;
+	uint16_t repeatCount = 0;
 };
 
 class MAX7360KeyMappingBase {
@@ -56,8 +74,16 @@ public:
 
 	virtual char rawToReadable(uint8_t rawValue) = 0;
 	virtual uint8_t readableToRaw(char c) = 0;
+
+#if MAX7360_ENABLE_KEYPAD
+	/**
+	 * @brief Get the columns that have at least one mapped key (bit D0 = COL0 ... D7 = COL7)
+	 */
+	virtual uint8_t getUsedColumnMask();
+#endif /* MAX7360_ENABLE_KEYPAD */
 };
 
+#if MAX7360_ENABLE_KEYPAD
 class MAX7360KeyMappingTable : public MAX7360KeyMappingBase {
 public:
 	MAX7360KeyMappingTable(const char *table, size_t tableSize);
@@ -108,6 +134,66 @@ public:
 	MAX7360KeyMappingPhone();
 	virtual ~MAX7360KeyMappingPhone();
 };
+#endif /* MAX7360_ENABLE_KEYPAD */
+
+/**
+ * @brief Saved copy of the MAX7360 register state, used by MAX7360::snapshot() and restore()
+ * 
+ * Holds registers 0x01 - 0x06 and 0x40 - 0x5f (38 bytes). The key FIFO (0x00) is not included.
+ * The read-only registers 0x48 - 0x4a are not read by MAX7360::snapshot() and are always 0.
+ */
+struct MAX7360Snapshot {
+	static const uint8_t LOW_FIRST = 0x01;		//!< First register in low
+	static const size_t LOW_COUNT = 6;			//!< Registers 0x01 - 0x06
+	static const uint8_t GPIO_FIRST = 0x40;		//!< First register in gpio
+	static const size_t GPIO_COUNT = 32;		//!< Registers 0x40 - 0x5f
+
+	uint8_t low[LOW_COUNT];						//!< Registers 0x01 - 0x06
+	uint8_t gpio[GPIO_COUNT];					//!< Registers 0x40 - 0x5f
+
+	/**
+	 * @brief Returns true if reg is one of the registers in the snapshot
+	 */
+	static bool contains(uint8_t reg) { 
+		return (reg >= LOW_FIRST && reg < LOW_FIRST + LOW_COUNT) || (reg >= GPIO_FIRST && reg < GPIO_FIRST + GPIO_COUNT);
+	};
+
+	/**
+	 * @brief Get the saved value of a register. Returns 0 if reg is not in the snapshot.
+	 */
+	uint8_t getRegister(uint8_t reg) const {
+		if (reg >= LOW_FIRST && reg < LOW_FIRST + LOW_COUNT) {
+			return low[reg - LOW_FIRST];
+		}
+		if (reg >= GPIO_FIRST && reg < GPIO_FIRST + GPIO_COUNT) {
+			return gpio[reg - GPIO_FIRST];
+		}
+		return 0;
+	};
+
+	/**
+	 * @brief Change the saved value of a register, for example to prepare an LED scene. Ignored if reg is not in the snapshot.
+	 */
+	void setRegister(uint8_t reg, uint8_t value) {
+		if (reg >= LOW_FIRST && reg < LOW_FIRST + LOW_COUNT) {
+			low[reg - LOW_FIRST] = value;
+		}
+		else
+		if (reg >= GPIO_FIRST && reg < GPIO_FIRST + GPIO_COUNT) {
+			gpio[reg - GPIO_FIRST] = value;
+		}
+	};
+};
+
+/**
+ * @brief Bus lock statistics from MAX7360::getLockStats() when thread-safe mode is enabled
+ */
+struct MAX7360LockStats {
+	uint32_t lockCount;				//!< Number of times the bus lock was acquired
+	uint32_t contendedCount;		//!< Number of times the wait was at least MAX7360::LOCK_CONTENDED_US
+	uint32_t totalWaitUs;			//!< Total time waiting for the lock in microseconds
+	uint32_t maxWaitUs;				//!< Longest wait for the lock in microseconds
+};
 
 /**
  * @brief Class for the MAX7360 LED driver
@@ -152,6 +238,35 @@ public:
 	 */
 	MAX7360KeyMappingBase *getKeyMapping() { return keyMapping; };
 
+#if MAX7360_ENABLE_INSTRUMENTATION
+	/**
+	 * @brief Sets a trace recorder to log FIFO, GPIO input, and rotary reads to
+	 * 
+	 * @param traceRecorder The MAX7360TraceRecorder object, or 0 to stop recording
+	 */
+	MAX7360 &withTraceRecorder(MAX7360TraceRecorder *traceRecorder) { this->traceRecorder = traceRecorder; return *this; };
+
+	/**
+	 * @brief Sets a latency monitor to timestamp FIFO reads. MAX7360LatencyMonitor::begin() calls this for you.
+	 */
+	MAX7360 &withLatencyMonitor(MAX7360LatencyMonitor *latencyMonitor) { this->latencyMonitor = latencyMonitor; return *this; };
+#endif /* MAX7360_ENABLE_INSTRUMENTATION */
+
+
+	/**
+	 * @brief Sets the I2C bus speed to use in begin()
+	 * 
+	 * @param speed CLOCK_SPEED_100KHZ (default) or CLOCK_SPEED_400KHZ (fast mode)
+	 * 
+	 * The MAX7360 supports fast mode (400 kHz). If any other device on the bus does not, leave it
+	 * at the default. Other devices on the same bus share the speed.
+	 */
+	MAX7360 &withBusSpeed(uint32_t speed) { busSpeed = speed; return *this; };
+
+	/**
+	 * @brief Gets the I2C bus speed in use, which can be lower than withBusSpeed() if begin() fell back to 100 kHz
+	 */
+	uint32_t getBusSpeed() const { return busSpeed; };
 
 	/**
 	 * @brief Set up the I2C device and begin running.
@@ -159,16 +274,55 @@ public:
 	 * You cannot do this from STARTUP or global object construction time. It should only be done from setup
 	 * or loop (once).
 	 *
-	 * Make sure you set the LED current using withLEDCurrent() before calling begin if your LED has a
-	 * current other than the default of 5 mA.
+	 * If a bus speed other than 100 kHz was set using withBusSpeed(), the bus is checked by writing and
+	 * reading back test values in the PORT7 PWM ratio register (which is then restored). If this fails,
+	 * the bus is restarted at 100 kHz.
+	 * 
+	 * The bus speed can only be changed before the I2C bus is started, so call this before
+	 * begin() for any other devices on the same bus.
+	 * 
+	 * @return At the default 100 kHz no check is done and this always returns true, whether or not
+	 * the chip is present; call checkBus() if you need to know. With another speed set by
+	 * withBusSpeed(), true if the chip responds, false if the check failed at 100 kHz too.
 	 */
 	bool begin();
 
+	/**
+	 * @brief Check communication with the chip by writing and reading back the PORT7 PWM ratio register
+	 * 
+	 * The original value is restored afterwards.
+	 * 
+	 * @return true if the values read back match
+	 */
+	bool checkBus();
+
 	/**
 	 * @brief Resets values to power-on defaults
 	 */
 	bool resetRegisterDefaults();
 
+	/**
+	 * @brief Save the state of all registers
+	 * 
+	 * @param snapshot Filled in with registers 0x01 - 0x06 and 0x40 - 0x5f
+	 * 
+	 * This is three burst read transactions (0x01 - 0x06, 0x40 - 0x47, 0x4b - 0x5f). Registers
+	 * 0x48 - 0x4a are not read, because reading them clears the I2C timeout flag, the rotary switch
+	 * count, and the port interrupt, and are 0 in the snapshot.
+	 */
+	bool snapshot(MAX7360Snapshot &snapshot);
+
+	/**
+	 * @brief Restore registers saved by snapshot()
+	 * 
+	 * @param snapshot The saved registers
+	 * 
+	 * This is three burst write transactions (0x01 - 0x06, 0x40 - 0x46, 0x50 - 0x5f). The read-only
+	 * registers (0x48 - 0x4a) and the non-existent registers are skipped, and the GPIO reset bit
+	 * in 0x40 is never written as 1.
+	 */
+	bool restore(const MAX7360Snapshot &snapshot);
+
 	/**
 	 * @brief Read keypad FIFO
 	 * 
@@ -222,6 +376,80 @@ public:
 	 */
 	bool setDebounceTimeMs(uint8_t ms);
 
+	/**
+	 * @brief Sets the auto-sleep time
+	 * 
+	 * @param value The auto-sleep setting, one of:
+	 * 
+	 * - REG_AUTO_SLEEP_DISABLED		No auto-sleep
+	 * - REG_AUTO_SLEEP_8192_MS			Sleep after 8192 ms of inactivity
+	 * - REG_AUTO_SLEEP_4096_MS			Sleep after 4096 ms of inactivity
+	 * - REG_AUTO_SLEEP_2048_MS			Sleep after 2048 ms of inactivity
+	 * - REG_AUTO_SLEEP_1024_MS			Sleep after 1024 ms of inactivity
+	 * - REG_AUTO_SLEEP_512_MS			Sleep after 512 ms of inactivity
+	 * - REG_AUTO_SLEEP_256_MS			Sleep after 256 ms of inactivity
+	 * 
+	 * Key scanning stops while the chip is asleep. Enable auto wake-up (setConfigurationAutoWakeUp)
+	 * so a key press wakes it back up.
+	 */
+	bool setAutoSleep(uint8_t value) { return writeRegister(REG_AUTO_SLEEP, value & REG_AUTO_SLEEP_MASK); };
+
+	/**
+	 * @brief Gets the auto-sleep setting (one of the REG_AUTO_SLEEP_ constants)
+	 */
+	uint8_t getAutoSleep() { return readRegister(REG_AUTO_SLEEP) & REG_AUTO_SLEEP_MASK; };
+
+	/**
+	 * @brief Configure key auto-repeat using register values
+	 * 
+	 * @param enable true to enable auto-repeat, false to disable (power-on default)
+	 * 
+	 * @param delayCode Time before the first repeat, 0 - 15. The delay is (delayCode + 1) * 8 debounce cycles.
+	 * 
+	 * @param rateCode Time between repeats, 0 - 7. The interval is (rateCode + 1) * 4 debounce cycles.
+	 * 
+	 * Auto-repeat codes (FIFO_KEY_REPEAT_MORE, FIFO_KEY_REPEAT_DONE) are put in the FIFO while
+	 * the key is held. They don't include the key number; it's the last key pressed.
+	 */
+	bool setAutoRepeat(bool enable, uint8_t delayCode = 0, uint8_t rateCode = 0);
+
+	/**
+	 * @brief Configure key auto-repeat in milliseconds
+	 * 
+	 * @param delayMs Time before the first repeat in milliseconds. 0 disables auto-repeat.
+	 * 
+	 * @param rateMs Time between repeats in milliseconds
+	 * 
+	 * The times are converted to debounce cycles using the current debounce time
+	 * (getDebounceTimeMs), so set the debounce time first. The closest supported
+	 * values are used.
+	 */
+	bool setAutoRepeatMs(unsigned int delayMs, unsigned int rateMs);
+
+	/**
+	 * @brief Gets the raw auto-repeat register value
+	 */
+	uint8_t getAutoRepeat() { return readRegister(REG_AUTO_REPEAT); };
+
+#if MAX7360_ENABLE_KEYPAD
+	/**
+	 * @brief Combine consecutive auto-repeat codes into one event (default: false)
+	 * 
+	 * When enabled, readKeyFIFO() reads ahead while it gets FIFO_KEY_REPEAT_MORE codes and
+	 * returns one repeat event with the number of repeats in MAX7360Key::getRepeatCount().
+	 * A held key then produces one event per read instead of one per repeat.
+	 */
+	MAX7360 &withRepeatCoalescing(bool enable = true) { repeatCoalescing = enable; return *this; };
+#endif /* MAX7360_ENABLE_KEYPAD */
+
+	/**
+	 * @brief Sets the key-switch interrupt register, which controls when /INTK is asserted
+	 * 
+	 * @param value The raw register value. 0x00 (power-up default) disables /INTK. See the
+	 * datasheet for the other values.
+	 */
+	bool setKeySwitchInterrupt(uint8_t value) { return writeRegister(REG_KEY_SWITCH_INTERRUPT, value); };
+
 	/**
 	 * @brief Gets the current GPO enable state.
 	 * 
@@ -253,6 +481,52 @@ public:
 	 */
 	bool setGpoEnable(uint8_t value);
 
+#if MAX7360_ENABLE_KEYPAD
+	/**
+	 * @brief Set the GPO enable from the key mapping (withKeyMapping) so only the columns it uses are scanned
+	 * 
+	 * Columns above the highest column with a mapped key are switched to GPO, so they're no
+	 * longer scanned and can be used as outputs (writeGpoOutputs). COL0 and COL1 are always
+	 * keypad columns. For the 4x3 phone keypad this is REG_GPO_ENABLE_76543 (COL0 - COL2
+	 * scanned, COL3 - COL7 GPO).
+	 * 
+	 * The chip only frees columns from the top down and always scans all 8 rows, so unused rows
+	 * and unused columns between used ones are still scanned.
+	 * 
+	 * @return false if there is no key mapping or the register could not be written
+	 */
+	bool configureForKeyMapping();
+#endif /* MAX7360_ENABLE_KEYPAD */
+
+
+#if MAX7360_ENABLE_GPIO
+	/**
+	 * @brief Set GPO outputs on the COL pins that are enabled as GPO (setGpoEnable)
+	 * 
+	 * @param mask The outputs to change. Use the GPO_COLx_MASK constants, ORed together.
+	 * 
+	 * @param values The new output values for the bits in mask. Bits not in mask are ignored.
+	 * 
+	 * The output state is shadowed, so changing any number of outputs is exactly one register
+	 * write and no reads. If nothing changes, nothing is written. The shadow is the register
+	 * cache (see getCachedRegister()), which is filled in by resetRegisterDefaults(), or
+	 * by one read the first time if you haven't called it.
+	 * 
+	 * The COL pins are open-drain outputs.
+	 */
+	bool writeGpoOutputs(uint8_t mask, uint8_t values);
+
+	/**
+	 * @brief Toggle GPO outputs on the COL pins. One register write, no reads.
+	 * 
+	 * @param mask The outputs to toggle (GPO_COLx_MASK constants ORed together)
+	 */
+	bool toggleGpoOutputs(uint8_t mask);
+
+	/**
+	 * @brief Get the GPO output state from the shadow (no bus access once the shadow is known)
+	 */
+	uint8_t getGpoOutputs();
 
 	/**
 	 * @brief Sets the GPIO Output mode (constant current or non-constant current)
@@ -290,8 +564,10 @@ public:
 	 * - 1 Port is an output
 	 */
 	bool setGpioInputOutputMode(uint8_t value) { return writeRegister(REG_GPIO_CONTROL, value); };
+#endif /* MAX7360_ENABLE_GPIO */
 
 
+#if MAX7360_ENABLE_LED
 	/**
 	 * @brief Set common PWM ratio
 	 * 
@@ -314,7 +590,9 @@ public:
 	 * 
 	 */
 	bool setPortPwmRatio(uint8_t port, uint8_t ratio) { return writeRegister(REG_PORT_PWM_RATIO + port, ratio); };
+#endif /* MAX7360_ENABLE_LED */
 
+#if MAX7360_ENABLE_GPIO
 	/**
 	 * @brief Sets port interrupt settings
 	 * 
@@ -325,7 +603,9 @@ public:
 	 * @param risingAndFalling true to generate interrupts on rising and falling edge, false for just rising edge
 	 */
 	bool setPortInterrupt(uint8_t port, bool enabled, bool risingAndFalling);
+#endif /* MAX7360_ENABLE_GPIO */
 
+#if MAX7360_ENABLE_LED
 	/**
 	 * @brief Set PWM mode for this port (common or individual)
 	 * 
@@ -366,7 +646,9 @@ public:
 	 * - REG_PORT_BLINK_ON_6_25_PCT	 = 3;	LED on for 6.25% of blink period
 	 */
 	bool setBlinkOnTimePercent(uint8_t port, uint8_t value) { return setRegisterMask(REG_PORT_CONFIG + port, ~REG_PORT_BLINK_ON_TIME_MASK, value); }
+#endif /* MAX7360_ENABLE_LED */
 
+#if MAX7360_ENABLE_ROTARY
 	/**
 	 * @brief Enable rotary encoder mode (power-on default is disabled)
 	 * 
@@ -375,6 +657,7 @@ public:
 	 * Enabling rotary encoder mode takes over PORT6 and PORT7 for the quadrature decoder.
 	 */
 	bool setConfigRotaryEncoder(bool enable = true) { return setRegisterBitmask(REG_GPIO_CONFIG, REG_GPIO_CONFIG_ROTARY_MASK, enable); };
+#endif /* MAX7360_ENABLE_ROTARY */
 
 	/**
 	 * @brief Enable using /INTI to indicate I2C bus timeouts (power-on default is disabled)
@@ -397,6 +680,7 @@ public:
 	 */
 	bool setConfigResetGpio() { return setRegisterBitmask(REG_GPIO_CONFIG, REG_GPIO_CONFIG_RESET_MASK, true); };
 
+#if MAX7360_ENABLE_LED
 	/**
 	 * @brief Set fade time
 
@@ -408,7 +692,9 @@ public:
 	 * - REG_GPIO_CONFIG_FADE_TIME_4096_MS	= 0x05;		Fade time 4096 ms
 	 */
 	bool setConfigFadeTime(uint8_t value) { return setRegisterMask(REG_GPIO_CONFIG, ~REG_GPIO_CONFIG_FADE_TIME_MASK, value); };
+#endif /* MAX7360_ENABLE_LED */
 
+#if MAX7360_ENABLE_GPIO
 	/**
 	 * @brief Reads the GPIO inputs when PORTx are configured as inputs
 	 * 
@@ -422,14 +708,17 @@ public:
 	 * - Bit D0 (mask 0b00000001) = PORT0
 	 * 
 	 */
-	uint8_t readGpioInputs() { return readRegister(REG_GPIO_INPUT); };
+	uint8_t readGpioInputs();
+#endif /* MAX7360_ENABLE_GPIO */
 
+#if MAX7360_ENABLE_ROTARY
 	/**
 	 * @brief Reads the rotary switch counter
 	 * 
 	 * @return A signed number of clicks since the last read
 	 */
-	int8_t readRotarySwitchCount() { return (int8_t) readRegister(REG_GPIO_ROTARY_SWITCH_COUNT); };
+	int8_t readRotarySwitchCount();
+#endif /* MAX7360_ENABLE_ROTARY */
 
 
 
@@ -447,12 +736,43 @@ public:
 	 *
 	 * @param value The value to set
 	 *
-	 * Note that setProgram bypasses this to write multiple bytes at once, to improve efficiency.
+	 * Use writeRegisters() to write multiple consecutive registers at once, to improve efficiency.
 	 */
 	bool writeRegister(uint8_t reg, uint8_t value);
 
+	/**
+	 * @brief Low-level call to read consecutive registers in a single transaction
+	 *
+	 * @param reg The first register to read
+	 *
+	 * @param values Buffer to store the values in
+	 *
+	 * @param count Number of registers to read (1 - 32)
+	 *
+	 * The MAX7360 increments the register address after each byte, so this reads reg, reg + 1, ...
+	 * 
+	 * @return true if all of the bytes were read
+	 */
+	bool readRegisters(uint8_t reg, uint8_t *values, size_t count);
+
+	/**
+	 * @brief Low-level call to write consecutive registers in a single transaction
+	 *
+	 * @param reg The first register to write
+	 *
+	 * @param values The values to write
+	 *
+	 * @param count Number of registers to write (1 - 31)
+	 *
+	 * The MAX7360 increments the register address after each byte, so this writes reg, reg + 1, ...
+	 */
+	bool writeRegisters(uint8_t reg, const uint8_t *values, size_t count);
+
 	/**
 	 * @brief Set the register value using and and or masks
+	 * 
+	 * In thread-safe mode, the bus is locked across the read and the write so the
+	 * read-modify-write can't be split by another thread.
 	 */
 	bool setRegisterMask(uint8_t reg, uint8_t andValue, uint8_t orValue);
 
@@ -461,6 +781,55 @@ public:
 	 */
 	bool setRegisterBitmask(uint8_t reg, uint8_t bitMask, bool set = true);
 
+	/**
+	 * @brief Lock the I2C bus around each transaction (default: false)
+	 * 
+	 * Enable this if the MAX7360 (or anything else on the same I2C bus) is used from more than one
+	 * thread, such as a worker thread and loop() with SYSTEM_THREAD(ENABLED). The lock is held
+	 * for one transaction, or for the read and write of a read-modify-write, not for a whole
+	 * sequence of calls, so a slow LED sequence in one thread doesn't hold up reading keys in
+	 * another.
+	 * 
+	 * Reading the key FIFO should still be done from one thread, as repeat coalescing keeps
+	 * read-ahead state.
+	 */
+	MAX7360 &withThreadSafe(bool enable = true) { threadSafe = enable; return *this; };
+
+	/**
+	 * @brief Get the last value read from or written to a register without accessing the bus
+	 * 
+	 * @param reg The register (0x01 - 0x06 or 0x40 - 0x5f)
+	 * 
+	 * @param value Filled in with the cached value
+	 * 
+	 * @return true if there is a cached value, false if the register hasn't been read or written
+	 * yet (or was reset), or is not cached.
+	 * 
+	 * This does not lock, so it's safe to call from any thread at any time. The cache only knows
+	 * about reads and writes made through this object. REG_I2C_TIMEOUT_FLAG and
+	 * REG_GPIO_ROTARY_SWITCH_COUNT are not cached because reading them clears them.
+	 */
+	bool getCachedRegister(uint8_t reg, uint8_t &value) const;
+
+	/**
+	 * @brief Forget all cached register values
+	 */
+	void invalidateCache();
+
+#if MAX7360_ENABLE_INSTRUMENTATION
+	/**
+	 * @brief Get bus lock statistics (thread-safe mode only)
+	 */
+	MAX7360LockStats getLockStats() const { return lockStats; };
+
+	/**
+	 * @brief Clear the bus lock statistics
+	 */
+	void resetLockStats();
+#endif /* MAX7360_ENABLE_INSTRUMENTATION */
+
+	static const uint32_t LOCK_CONTENDED_US = 5;	//!< Lock waits at least this long are counted as contended
+
 
 	static const uint8_t REG_KEYS_FIFO = 0x00;			//!< Read the keys FIFO register
 
@@ -485,8 +854,26 @@ public:
 	
 	static const uint8_t REG_KEY_SWITCH_INTERRUPT			= 0x03; 	//!< /INTK interruot control register
 	static const uint8_t REG_GPO_CONTROL					= 0x04; 	//!< Control of COL pins and /INTK used a GPO
+	static const uint8_t GPO_COL7_MASK						= 0x80;		//!< REG_GPO_CONTROL bit for COL7
+	static const uint8_t GPO_COL6_MASK						= 0x40;		//!< REG_GPO_CONTROL bit for COL6
+	static const uint8_t GPO_COL5_MASK						= 0x20;		//!< REG_GPO_CONTROL bit for COL5
+	static const uint8_t GPO_COL4_MASK						= 0x10;		//!< REG_GPO_CONTROL bit for COL4
+	static const uint8_t GPO_COL3_MASK						= 0x08;		//!< REG_GPO_CONTROL bit for COL3
+	static const uint8_t GPO_COL2_MASK						= 0x04;		//!< REG_GPO_CONTROL bit for COL2
 	static const uint8_t REG_AUTO_REPEAT					= 0x05; 	//!< Auto-repeat settings
+	static const uint8_t REG_AUTO_REPEAT_ENABLE_MASK		= 0x80;		//!< Auto-repeat enabled (D7) (default: disabled)
+	static const uint8_t REG_AUTO_REPEAT_RATE_MASK			= 0x70;		//!< Auto-repeat rate (D6 - D4)
+	static const uint8_t REG_AUTO_REPEAT_RATE_SHIFT			= 4;		//!< Auto-repeat rate bit offset
+	static const uint8_t REG_AUTO_REPEAT_DELAY_MASK			= 0x0f;		//!< Auto-repeat delay (D3 - D0)
 	static const uint8_t REG_AUTO_SLEEP						= 0x06; 	//!< Auto-sleep settings
+	static const uint8_t REG_AUTO_SLEEP_MASK				= 0x07;		//!< Auto-sleep time is in the low 3 bits (D2 - D0)
+	static const uint8_t REG_AUTO_SLEEP_DISABLED			= 0x00;		//!< No auto-sleep
+	static const uint8_t REG_AUTO_SLEEP_8192_MS				= 0x01;		//!< Auto-sleep after 8192 ms of inactivity
+	static const uint8_t REG_AUTO_SLEEP_4096_MS				= 0x02;		//!< Auto-sleep after 4096 ms of inactivity
+	static const uint8_t REG_AUTO_SLEEP_2048_MS				= 0x03;		//!< Auto-sleep after 2048 ms of inactivity
+	static const uint8_t REG_AUTO_SLEEP_1024_MS				= 0x04;		//!< Auto-sleep after 1024 ms of inactivity
+	static const uint8_t REG_AUTO_SLEEP_512_MS				= 0x05;		//!< Auto-sleep after 512 ms of inactivity
+	static const uint8_t REG_AUTO_SLEEP_256_MS				= 0x06;		//!< Auto-sleep after 256 ms of inactivity
 
 	// There is no register 0x07 to 0x3f
 
@@ -586,7 +973,46 @@ public:
 	static const uint8_t PORT1_MASK							= 0b00000010; //!< PORT1 (bit D1) mask
 	static const uint8_t PORT0_MASK							= 0b00000001; //!< PORT0 (bit D0) mask
 
+	static const size_t I2C_BUFFER_SIZE						= 32;		//!< Maximum bytes in one I2C transaction (Wire buffer size)
+
 protected:
+#if MAX7360_ENABLE_GPIO
+	/**
+	 * @brief Get the GPO control register from the shadow, reading it once if it's not known
+	 */
+	uint8_t getGpoShadow();
+#endif /* MAX7360_ENABLE_GPIO */
+
+	/**
+	 * @brief Read one byte from the key FIFO, or the byte read ahead while coalescing repeats
+	 */
+	uint8_t readFifoRaw();
+
+	/**
+	 * @brief Lock the I2C bus if in thread-safe mode. Recursive.
+	 */
+	void lockBus();
+
+	/**
+	 * @brief Unlock the I2C bus if in thread-safe mode
+	 */
+	void unlockBus();
+
+	/**
+	 * @brief Store values read or written in the register cache
+	 * 
+	 * @param isWrite true for values written. Writing the GPIO reset bit invalidates 0x40 - 0x5f.
+	 *
+	 * Must be called with the bus locked, in the same lock as the transaction, so the cache
+	 * can't be updated out of order with another thread's access to the same register.
+	 */
+	void updateCache(uint8_t reg, const uint8_t *values, size_t count, bool isWrite);
+
+	/**
+	 * @brief Index into cache for a register, or -1 if not cached
+	 */
+	static int cacheIndex(uint8_t reg);
+
 	/**
 	 * @brief The I2C address (0x00 - 0x7f). Default is 0x37.
 	 *
@@ -599,8 +1025,42 @@ protected:
 	 */
 	TwoWire &wire;
 
+	/**
+	 * @brief I2C bus speed (CLOCK_SPEED_100KHZ or CLOCK_SPEED_400KHZ)
+	 */
+	uint32_t busSpeed = CLOCK_SPEED_100KHZ;
 
 	MAX7360KeyMappingBase *keyMapping = 0;
+
+#if MAX7360_ENABLE_INSTRUMENTATION
+	MAX7360TraceRecorder *traceRecorder = 0;
+
+	MAX7360LatencyMonitor *latencyMonitor = 0;
+#endif /* MAX7360_ENABLE_INSTRUMENTATION */
+
+	bool threadSafe = false;
+#if MAX7360_ENABLE_INSTRUMENTATION
+	MAX7360LockStats lockStats = {0, 0, 0, 0};
+#endif /* MAX7360_ENABLE_INSTRUMENTATION */
+
+	/**
+	 * @brief Cached register values, 0x01 - 0x06 then 0x40 - 0x5f (same layout as MAX7360Snapshot)
+	 */
+	volatile uint8_t cache[MAX7360Snapshot::LOW_COUNT + MAX7360Snapshot::GPIO_COUNT];
+
+	/**
+	 * @brief Bit n % 32 of word n / 32 set if cache[n] is valid
+	 *
+	 * Two 32-bit words instead of a uint64_t so each one can be read atomically without the lock.
+	 * They are only changed with the bus locked.
+	 */
+	volatile uint32_t cacheValid[2] = {0, 0};
+
+#if MAX7360_ENABLE_KEYPAD
+	bool repeatCoalescing = false;
+	bool hasReadAhead = false;
+	uint8_t readAhead = 0;
+#endif /* MAX7360_ENABLE_KEYPAD */
 };
 
 
@@ -0,0 +1,121 @@
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+
+#include "MAX7360Color.h"
+
+#if MAX7360_ENABLE_LED
+
+constexpr uint8_t MAX7360Color::gammaTable[256];
+
+void MAX7360Color::hsvToRgb(uint8_t hue, uint8_t sat, uint8_t val, uint8_t *rgb) {
+	if (sat == 0) {
+		rgb[0] = rgb[1] = rgb[2] = val;
+		return;
+	}
+
+	// Six regions of 43 hue steps each. remainder is scaled to 0 - 255 within the region.
+	uint8_t region = hue / 43;
+	uint16_t remainder = (uint16_t)(hue - (region * 43)) * 6;
+
+	uint8_t p = (uint8_t)(((uint16_t)val * (255 - sat)) >> 8);
+	uint8_t q = (uint8_t)(((uint16_t)val * (255 - ((sat * remainder) >> 8))) >> 8);
+	uint8_t t = (uint8_t)(((uint16_t)val * (255 - ((sat * (255 - remainder)) >> 8))) >> 8);
+
+	switch(region) {
+	case 0:
+		rgb[0] = val; rgb[1] = t; rgb[2] = p;
+		break;
+	case 1:
+		rgb[0] = q; rgb[1] = val; rgb[2] = p;
+		break;
+	case 2:
+		rgb[0] = p; rgb[1] = val; rgb[2] = t;
+		break;
+	case 3:
+		rgb[0] = p; rgb[1] = q; rgb[2] = val;
+		break;
+	case 4:
+		rgb[0] = t; rgb[1] = p; rgb[2] = val;
+		break;
+	default:
+		rgb[0] = val; rgb[1] = p; rgb[2] = q;
+		break;
+	}
+}
+
+
+MAX7360RGBLed::MAX7360RGBLed(MAX7360 &chip, uint8_t redPort, uint8_t greenPort, uint8_t bluePort) : chip(chip) {
+	ports[0] = redPort;
+	ports[1] = greenPort;
+	ports[2] = bluePort;
+
+	firstPort = redPort;
+	if (greenPort < firstPort) {
+		firstPort = greenPort;
+	}
+	if (bluePort < firstPort) {
+		firstPort = bluePort;
+	}
+
+	// Adjacent if each port is a different one of firstPort, firstPort + 1, firstPort + 2
+	uint8_t mask = 0;
+	for(size_t ii = 0; ii < 3; ii++) {
+		uint8_t offset = ports[ii] - firstPort;
+		if (offset < 3) {
+			mask |= 1 << offset;
+		}
+	}
+	adjacent = (mask == 0b111);
+}
+
+MAX7360RGBLed::~MAX7360RGBLed() {
+
+}
+
+bool MAX7360RGBLed::setRGB(uint8_t red, uint8_t green, uint8_t blue) {
+	uint8_t color[3] = { red, green, blue };
+	uint8_t ratio[3];
+
+	for(size_t ii = 0; ii < 3; ii++) {
+		uint8_t value = gammaEnabled ? MAX7360Color::gamma(color[ii]) : color[ii];
+		if (adjacent) {
+			// Store by register order so it can be written in one burst
+			ratio[ports[ii] - firstPort] = value;
+		}
+		else {
+			ratio[ii] = value;
+		}
+	}
+
+	if (valid && memcmp(ratio, lastRatio, sizeof(ratio)) == 0) {
+		return true;
+	}
+
+	bool result;
+	if (adjacent) {
+		result = chip.writeRegisters(MAX7360::REG_PORT_PWM_RATIO + firstPort, ratio, sizeof(ratio));
+	}
+	else {
+		result = true;
+		for(size_t ii = 0; ii < 3; ii++) {
+			if (!valid || ratio[ii] != lastRatio[ii]) {
+				result = chip.setPortPwmRatio(ports[ii], ratio[ii]) && result;
+			}
+		}
+	}
+
+	memcpy(lastRatio, ratio, sizeof(ratio));
+	valid = result;
+
+	return result;
+}
+
+bool MAX7360RGBLed::setHSV(uint8_t hue, uint8_t sat, uint8_t val) {
+	uint8_t rgb[3];
+
+	MAX7360Color::hsvToRgb(hue, sat, val, rgb);
+
+	return setRGB(rgb[0], rgb[1], rgb[2]);
+}
+
+#endif /* MAX7360_ENABLE_LED */
@@ -0,0 +1,139 @@
+#ifndef __MAX7360COLOR_H
+#define __MAX7360COLOR_H
+
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+
+#include "MAX7360-RK.h"
+
+#if MAX7360_ENABLE_LED
+
+/**
+ * @brief Color and brightness conversions for LEDs on the PWM ports
+ *
+ * All of the conversions use integer math only.
+ */
+class MAX7360Color {
+public:
+	/**
+	 * @brief Convert a perceptual brightness (0 - 255) to a PWM ratio (0 - 255)
+	 *
+	 * The eye's response to brightness is non-linear, so a PWM ratio of 128 looks much brighter
+	 * than half of 255. This uses a gamma 2.8 lookup table so equal steps in brightness look like
+	 * equal steps in brightness.
+	 */
+	static uint8_t gamma(uint8_t brightness) { return gammaTable[brightness]; };
+
+	/**
+	 * @brief Convert HSV (hue, saturation, value) to RGB
+	 *
+	 * @param hue Hue 0 - 255. 0 = red, 85 = green, 170 = blue, wrapping back to red at 256.
+	 *
+	 * @param sat Saturation 0 - 255. 0 = white, 255 = fully saturated.
+	 *
+	 * @param val Value (brightness) 0 - 255.
+	 *
+	 * @param rgb Filled in with the red, green, and blue values 0 - 255 (not gamma corrected)
+	 */
+	static void hsvToRgb(uint8_t hue, uint8_t sat, uint8_t val, uint8_t *rgb);
+
+	/**
+	 * @brief Gamma 2.8 lookup table. Index is the perceptual brightness, value is the PWM ratio.
+	 */
+	static constexpr uint8_t gammaTable[256] = {
+		  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+		  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1,   1,   1,   1,
+		  1,   1,   1,   1,   1,   1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,
+		  2,   3,   3,   3,   3,   3,   3,   3,   4,   4,   4,   4,   4,   5,   5,   5,
+		  5,   6,   6,   6,   6,   7,   7,   7,   7,   8,   8,   8,   9,   9,   9,  10,
+		 10,  10,  11,  11,  11,  12,  12,  13,  13,  13,  14,  14,  15,  15,  16,  16,
+		 17,  17,  18,  18,  19,  19,  20,  20,  21,  21,  22,  22,  23,  24,  24,  25,
+		 25,  26,  27,  27,  28,  29,  29,  30,  31,  32,  32,  33,  34,  35,  35,  36,
+		 37,  38,  39,  39,  40,  41,  42,  43,  44,  45,  46,  47,  48,  49,  50,  50,
+		 51,  52,  54,  55,  56,  57,  58,  59,  60,  61,  62,  63,  64,  66,  67,  68,
+		 69,  70,  72,  73,  74,  75,  77,  78,  79,  81,  82,  83,  85,  86,  87,  89,
+		 90,  92,  93,  95,  96,  98,  99, 101, 102, 104, 105, 107, 109, 110, 112, 114,
+		115, 117, 119, 120, 122, 124, 126, 127, 129, 131, 133, 135, 137, 138, 140, 142,
+		144, 146, 148, 150, 152, 154, 156, 158, 160, 162, 164, 167, 169, 171, 173, 175,
+		177, 180, 182, 184, 186, 189, 191, 193, 196, 198, 200, 203, 205, 208, 210, 213,
+		215, 218, 220, 223, 225, 228, 231, 233, 236, 239, 241, 244, 247, 249, 252, 255
+	};
+};
+
+/**
+ * @brief An RGB LED connected to three PWM ports
+ *
+ * The ports must be configured as outputs (setGpioInputOutputMode) and GPIO enabled
+ * (setConfigEnableGpio) first.
+ *
+ * If the three ports are adjacent (such as PORT0, PORT1, PORT2, in any order), each color change
+ * is a single burst write to the three PWM ratio registers. Otherwise it takes three writes.
+ * Setting the same color again does not write anything.
+ */
+class MAX7360RGBLed {
+public:
+	/**
+	 * @brief Construct an RGB LED object
+	 *
+	 * @param chip The MAX7360 object
+	 *
+	 * @param redPort Port for red (0 - 7, default: 0)
+	 *
+	 * @param greenPort Port for green (0 - 7, default: 1)
+	 *
+	 * @param bluePort Port for blue (0 - 7, default: 2)
+	 */
+	MAX7360RGBLed(MAX7360 &chip, uint8_t redPort = 0, uint8_t greenPort = 1, uint8_t bluePort = 2);
+	virtual ~MAX7360RGBLed();
+
+	/**
+	 * @brief Enable or disable gamma correction (default: enabled)
+	 */
+	MAX7360RGBLed &withGamma(bool enable = true) { gammaEnabled = enable; return *this; };
+
+	/**
+	 * @brief Set the color
+	 *
+	 * @param red Red brightness 0 - 255
+	 *
+	 * @param green Green brightness 0 - 255
+	 *
+	 * @param blue Blue brightness 0 - 255
+	 */
+	bool setRGB(uint8_t red, uint8_t green, uint8_t blue);
+
+	/**
+	 * @brief Set the color as a packed 0xRRGGBB value
+	 */
+	bool setRGB(uint32_t rgb) { return setRGB((uint8_t)(rgb >> 16), (uint8_t)(rgb >> 8), (uint8_t)rgb); };
+
+	/**
+	 * @brief Set the color using hue, saturation, and value. See MAX7360Color::hsvToRgb().
+	 */
+	bool setHSV(uint8_t hue, uint8_t sat, uint8_t val);
+
+	/**
+	 * @brief Turn the LED off
+	 */
+	bool off() { return setRGB(0, 0, 0); };
+
+	/**
+	 * @brief Forget the last color written, so the next set writes even if it's the same color
+	 *
+	 * Use this if something else changed the PWM ratio registers.
+	 */
+	void invalidate() { valid = false; };
+
+protected:
+	MAX7360 &chip;
+	uint8_t ports[3];				//!< Red, green, blue port numbers
+	uint8_t firstPort;				//!< Lowest port number, if the ports are adjacent
+	bool adjacent;					//!< true if the three ports are adjacent so they can be written in one burst
+	bool gammaEnabled = true;
+	bool valid = false;				//!< lastRatio is what's in the chip
+	uint8_t lastRatio[3];			//!< Last PWM ratios written, by port offset from firstPort (or red, green, blue if not adjacent)
+};
+
+#endif /* MAX7360_ENABLE_LED */
+
+#endif /* __MAX7360COLOR_H */
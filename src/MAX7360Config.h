@@ -0,0 +1,58 @@
+#ifndef __MAX7360CONFIG_H
+#define __MAX7360CONFIG_H
+
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+
+/**
+ * @file MAX7360Config.h
+ *
+ * @brief Compile-time feature selection
+ *
+ * Each feature defaults to enabled (1). To leave one out, define it to 0 for the whole build,
+ * for example with -DMAX7360_ENABLE_LED=0 in EXTRA_CFLAGS for a local build, or by changing
+ * the default here in your copy of the library. It must be the same for every file, so
+ * defining it in your application source before including the library is not enough.
+ *
+ * The raw register access, snapshot/restore, key FIFO, and basic keypad settings (debounce,
+ * auto-repeat, key interrupt, GPO enable) are always included; configureForKeyMapping() needs
+ * MAX7360_ENABLE_KEYPAD. tools/size-report.sh shows what each feature costs.
+ */
+
+#ifndef MAX7360_ENABLE_KEYPAD
+/**
+ * @brief Keypad helpers: key mapping tables, configureForKeyMapping(), repeat coalescing,
+ * MAX7360TextEntry, MAX7360KeyDispatcher, MAX7360GestureRecognizer, MAX7360GhostFilter
+ */
+#define MAX7360_ENABLE_KEYPAD 1
+#endif
+
+#ifndef MAX7360_ENABLE_GPIO
+/**
+ * @brief PORT0 - PORT7 GPIO and COL GPO outputs, including MAX7360GpioExpander
+ */
+#define MAX7360_ENABLE_GPIO 1
+#endif
+
+#ifndef MAX7360_ENABLE_LED
+/**
+ * @brief Port PWM, blink, and fade settings, MAX7360RGBLed, MAX7360Color, and MAX7360FadeEngine
+ */
+#define MAX7360_ENABLE_LED 1
+#endif
+
+#ifndef MAX7360_ENABLE_ROTARY
+/**
+ * @brief Rotary encoder on PORT6 and PORT7
+ */
+#define MAX7360_ENABLE_ROTARY 1
+#endif
+
+#ifndef MAX7360_ENABLE_INSTRUMENTATION
+/**
+ * @brief MAX7360TraceRecorder, MAX7360LatencyMonitor, and the bus lock statistics
+ */
+#define MAX7360_ENABLE_INSTRUMENTATION 1
+#endif
+
+#endif /* __MAX7360CONFIG_H */
@@ -0,0 +1,226 @@
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+
+#include "MAX7360EventStream.h"
+
+MAX7360EventStream *MAX7360EventStream::instance = 0;
+
+MAX7360EventStream::MAX7360EventStream(MAX7360 &chip, pin_t intkPin, pin_t intiPin) : chip(chip), intkPin(intkPin), intiPin(intiPin) {
+
+}
+
+MAX7360EventStream::~MAX7360EventStream() {
+	end();
+}
+
+bool MAX7360EventStream::begin() {
+	bool result = true;
+
+#if MAX7360_ENABLE_GPIO
+	if (portMask) {
+		lastInputs = chip.readGpioInputs();
+	}
+#endif
+#if MAX7360_ENABLE_ROTARY
+	if (rotary) {
+		// Discard movement from before begin
+		chip.readRotarySwitchCount();
+	}
+#endif
+
+	lastEventUs = monotonicUs();
+
+	instance = this;
+
+	if (intkPin != PIN_INVALID) {
+		pinMode(intkPin, INPUT_PULLUP);
+		result = attachInterrupt(intkPin, intkISR, FALLING) && result;
+	}
+	if (intiPin != PIN_INVALID) {
+		pinMode(intiPin, INPUT_PULLUP);
+		result = attachInterrupt(intiPin, intiISR, FALLING) && result;
+	}
+
+	// Read anything that was already waiting
+	intkPending = intiPending = true;
+	intkTimeUs = intiTimeUs = micros();
+
+	return result;
+}
+
+void MAX7360EventStream::end() {
+	if (instance == this) {
+		if (intkPin != PIN_INVALID) {
+			detachInterrupt(intkPin);
+		}
+		if (intiPin != PIN_INVALID) {
+			detachInterrupt(intiPin);
+		}
+		instance = 0;
+	}
+}
+
+size_t MAX7360EventStream::service() {
+	size_t count = 0;
+
+	// A falling edge can be missed if the line was still low from the previous event, so
+	// a low line counts as pending too
+	bool intk = (intkPin == PIN_INVALID) || intkPending || digitalRead(intkPin) == LOW;
+	bool inti = (intiPin == PIN_INVALID) || intiPending || digitalRead(intiPin) == LOW;
+
+	// Clear the flags before reading so an interrupt during the read is not lost
+	uint64_t intkUs = (intkPin == PIN_INVALID || !intkPending) ? monotonicUs() : toMonotonicUs(intkTimeUs);
+	intkPending = false;
+	uint64_t intiUs = (intiPin == PIN_INVALID || !intiPending) ? monotonicUs() : toMonotonicUs(intiTimeUs);
+	intiPending = false;
+
+	// Read the source that interrupted first first, so the stream stays in order
+	if (intk && inti && intiUs < intkUs) {
+		count += readInti(intiUs);
+		count += readKeys(intkUs);
+	}
+	else {
+		if (intk) {
+			count += readKeys(intkUs);
+		}
+		if (inti) {
+			count += readInti(intiUs);
+		}
+	}
+
+	return count;
+}
+
+size_t MAX7360EventStream::readKeys(uint64_t timeUs) {
+	size_t count = 0;
+
+	while(true) {
+		MAX7360Key key = chip.readKeyFIFO();
+		if (key.isEmpty()) {
+			break;
+		}
+
+		MAX7360Event event = {};
+		if (key.isOverflow()) {
+			event.type = MAX7360EventType::KEY_OVERFLOW;
+			// The press that the next repeats belong to may have been lost
+			lastPressedKey = MAX7360Key::FIFO_KEY_NONE;
+		}
+		else
+		if (key.isKeyRepeat() && lastPressedKey == MAX7360Key::FIFO_KEY_NONE) {
+			// No press seen since begin() or an overflow, so the key is unknown. Drop the repeat.
+			if (!key.hasMore()) {
+				break;
+			}
+			continue;
+		}
+		else
+		if (key.isKeyRepeat()) {
+			event.type = MAX7360EventType::KEY_REPEAT;
+			event.key.rawKey = lastPressedKey;
+			event.key.repeatCount = key.getRepeatCount();
+		}
+		else {
+			event.type = key.isReleased() ? MAX7360EventType::KEY_RELEASE : MAX7360EventType::KEY_PRESS;
+			event.key.rawKey = key.getRawKey();
+			event.key.repeatCount = 0;
+			if (!key.isReleased()) {
+				lastPressedKey = key.getRawKey();
+			}
+		}
+		if (addEvent(event, timeUs)) {
+			count++;
+		}
+
+		if (!key.hasMore()) {
+			break;
+		}
+	}
+	return count;
+}
+
+size_t MAX7360EventStream::readInti(uint64_t timeUs) {
+	size_t count = 0;
+
+#if MAX7360_ENABLE_GPIO
+	if (portMask) {
+		uint8_t inputs = chip.readGpioInputs();
+		uint8_t changed = (inputs ^ lastInputs) & portMask;
+		lastInputs = inputs;
+
+		for(; changed; changed &= changed - 1) {
+			uint8_t port = __builtin_ctz(changed);
+
+			MAX7360Event event = {};
+			event.type = MAX7360EventType::PORT_EDGE;
+			event.port.port = port;
+			event.port.level = (inputs & (1 << port)) ? HIGH : LOW;
+			if (addEvent(event, timeUs)) {
+				count++;
+			}
+		}
+	}
+#endif
+
+#if MAX7360_ENABLE_ROTARY
+	if (rotary) {
+		int8_t delta = chip.readRotarySwitchCount();
+		if (delta != 0) {
+			MAX7360Event event = {};
+			event.type = MAX7360EventType::ROTARY;
+			event.rotary.delta = delta;
+			if (addEvent(event, timeUs)) {
+				count++;
+			}
+		}
+	}
+#endif
+
+	return count;
+}
+
+bool MAX7360EventStream::addEvent(MAX7360Event &event, uint64_t timeUs) {
+	// Sources are read one at a time, so a later read can have an earlier interrupt time
+	if (timeUs < lastEventUs) {
+		timeUs = lastEventUs;
+	}
+	event.timeUs = timeUs;
+
+	if (!queue.push(event)) {
+		return false;
+	}
+	lastEventUs = timeUs;
+	return true;
+}
+
+uint64_t MAX7360EventStream::monotonicUs() {
+	uint32_t nowUs = micros();
+	if (nowUs < lastMicros) {
+		// micros() wrapped (every 71 minutes)
+		microsHigh += 0x100000000ULL;
+	}
+	lastMicros = nowUs;
+	return microsHigh | nowUs;
+}
+
+uint64_t MAX7360EventStream::toMonotonicUs(uint32_t isrUs) {
+	uint64_t nowUs = monotonicUs();
+	uint32_t elapsedUs = (uint32_t)nowUs - isrUs;
+	return (elapsedUs <= nowUs) ? nowUs - elapsedUs : 0;
+}
+
+void MAX7360EventStream::intkISR() {
+	MAX7360EventStream *stream = instance;
+	if (stream && !stream->intkPending) {
+		stream->intkTimeUs = micros();
+		stream->intkPending = true;
+	}
+}
+
+void MAX7360EventStream::intiISR() {
+	MAX7360EventStream *stream = instance;
+	if (stream && !stream->intiPending) {
+		stream->intiTimeUs = micros();
+		stream->intiPending = true;
+	}
+}
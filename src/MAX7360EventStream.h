@@ -0,0 +1,238 @@
+#ifndef __MAX7360EVENTSTREAM_H
+#define __MAX7360EVENTSTREAM_H
+
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+
+#include "MAX7360-RK.h"
+#include "MAX7360RingBuffer.h"
+
+/**
+ * @brief Type of a MAX7360Event
+ */
+enum class MAX7360EventType : uint8_t {
+	KEY_PRESS,			//!< Key pressed, key is valid
+	KEY_RELEASE,		//!< Key released, key is valid (key release events must be enabled)
+	KEY_REPEAT,			//!< Auto-repeat of the last key pressed, key is valid. Not generated until a press has been seen.
+	KEY_OVERFLOW,		//!< The key FIFO overflowed and key events were lost. The data fields are 0.
+	PORT_EDGE,			//!< A PORT input changed, port is valid
+	ROTARY				//!< The rotary encoder moved, rotary is valid
+};
+
+/**
+ * @brief An event from MAX7360EventStream
+ */
+struct MAX7360Event {
+	/**
+	 * @brief Data for KEY_PRESS, KEY_RELEASE, and KEY_REPEAT
+	 */
+	struct KeyData {
+		uint8_t rawKey;				//!< Raw key 0 - 63. For KEY_REPEAT, the last key pressed.
+		uint16_t repeatCount;		//!< Number of repeats for KEY_REPEAT (more than 1 with repeat coalescing)
+	};
+
+	/**
+	 * @brief Data for PORT_EDGE
+	 */
+	struct PortData {
+		uint8_t port;				//!< Port number 0 - 7
+		uint8_t level;				//!< New level, HIGH or LOW
+	};
+
+	/**
+	 * @brief Data for ROTARY
+	 */
+	struct RotaryData {
+		int8_t delta;				//!< Signed number of clicks
+	};
+
+	MAX7360EventType type;			//!< Which of key, port, or rotary is valid
+	uint64_t timeUs;				//!< When the interrupt for this event occurred, in microseconds. Never decreases.
+	union {
+		KeyData key;
+		PortData port;
+		RotaryData rotary;
+	};
+};
+
+/**
+ * @brief One time-ordered stream of key, port input, and rotary encoder events
+ *
+ * The interrupt handlers for /INTK and /INTI only record that the interrupt occurred and when,
+ * because the I2C bus can't be used from an ISR. Call service() from loop() (or a worker thread)
+ * to read the sources that were flagged: the key FIFO for /INTK, and the port inputs and rotary
+ * counter for /INTI. Each event is stamped with the time of its interrupt, and the stream is in
+ * timestamp order, so a key press and a port edge can be compared directly.
+ *
+ * If an interrupt pin is PIN_INVALID, its sources are read on every service() call instead, and
+ * events are stamped with the time of the read.
+ *
+ * Events are consumed with read(), or with the draining iterator from events():
+ *
+ * ```
+ * for(const MAX7360Event &event : eventStream.events()) {
+ *     // Each event is removed from the stream as the loop advances
+ * }
+ * ```
+ *
+ * Leaving the loop early with break leaves the current event and the ones after it in the stream.
+ *
+ * Nothing is allocated; the queue holds EVENT_QUEUE_SIZE events and newer events are discarded
+ * if it's full. Only one MAX7360EventStream can use interrupts at a time, and the /INTK
+ * interrupt can't also be used by MAX7360LatencyMonitor.
+ */
+class MAX7360EventStream {
+public:
+	/**
+	 * @brief Construct an event stream
+	 *
+	 * @param chip The MAX7360 object
+	 *
+	 * @param intkPin The MCU pin connected to /INTK, or PIN_INVALID to poll the key FIFO
+	 *
+	 * @param intiPin The MCU pin connected to /INTI, or PIN_INVALID to poll the ports and rotary encoder
+	 */
+	MAX7360EventStream(MAX7360 &chip, pin_t intkPin = PIN_INVALID, pin_t intiPin = PIN_INVALID);
+	virtual ~MAX7360EventStream();
+
+	/**
+	 * @brief Ports to generate PORT_EDGE events for (default: 0, none)
+	 *
+	 * The ports must be inputs. For /INTI to be asserted, also enable the port interrupt with
+	 * MAX7360::setPortInterrupt() (rising and falling).
+	 */
+	MAX7360EventStream &withPortMask(uint8_t portMask) { this->portMask = portMask; return *this; };
+
+	/**
+	 * @brief Generate ROTARY events (default: false). Enable the rotary encoder in the chip as well.
+	 */
+	MAX7360EventStream &withRotary(bool enable = true) { rotary = enable; return *this; };
+
+	/**
+	 * @brief Attach the interrupt handlers and read the initial port state. Call from setup() after MAX7360::begin().
+	 */
+	bool begin();
+
+	/**
+	 * @brief Detach the interrupt handlers
+	 */
+	void end();
+
+	/**
+	 * @brief Read the flagged sources into the stream. Call from loop().
+	 *
+	 * @return The number of events added
+	 */
+	size_t service();
+
+	/**
+	 * @brief Remove the oldest event from the stream
+	 *
+	 * @return true if an event was copied to event, false if the stream is empty
+	 */
+	bool read(MAX7360Event &event) { return queue.pop(event); };
+
+	/**
+	 * @brief Number of events waiting to be read
+	 */
+	size_t available() const { return queue.size(); };
+
+	/**
+	 * @brief Number of events discarded because the queue was full
+	 */
+	size_t getDropCount() const { return queue.getDropCount(); };
+
+	/**
+	 * @brief Iterator that removes each event from the stream as it advances
+	 */
+	class Iterator {
+	public:
+		Iterator(MAX7360EventStream *stream) : stream(stream) {};
+
+		const MAX7360Event &operator*() const { return *stream->queue.front(); };
+		const MAX7360Event *operator->() const { return stream->queue.front(); };
+		Iterator &operator++() { stream->queue.pop(event); return *this; };
+
+		/**
+		 * @brief Only compares against the end iterator: not equal while there are events
+		 */
+		bool operator!=(const Iterator &) const { return stream && !stream->queue.isEmpty(); };
+
+	protected:
+		MAX7360EventStream *stream;
+		MAX7360Event event;				//!< Popped event (discarded)
+	};
+
+	/**
+	 * @brief Range over the events in the stream, for use in a range-based for loop
+	 */
+	class Range {
+	public:
+		Range(MAX7360EventStream *stream) : stream(stream) {};
+
+		Iterator begin() const { return Iterator(stream); };
+		Iterator end() const { return Iterator(0); };
+
+	protected:
+		MAX7360EventStream *stream;
+	};
+
+	/**
+	 * @brief Get a draining range over the events in the stream
+	 */
+	Range events() { return Range(this); };
+
+	static const size_t EVENT_QUEUE_SIZE = 32;		//!< Maximum number of events waiting to be read
+
+protected:
+	/**
+	 * @brief Read the key FIFO until empty
+	 */
+	size_t readKeys(uint64_t timeUs);
+
+	/**
+	 * @brief Read the port inputs and rotary counter
+	 */
+	size_t readInti(uint64_t timeUs);
+
+	/**
+	 * @brief Add an event, keeping the timestamps in order
+	 */
+	bool addEvent(MAX7360Event &event, uint64_t timeUs);
+
+	/**
+	 * @brief Current time in microseconds, extended to 64 bits so it doesn't wrap
+	 */
+	uint64_t monotonicUs();
+
+	/**
+	 * @brief Convert a micros() value recorded by an ISR to the 64-bit time
+	 */
+	uint64_t toMonotonicUs(uint32_t isrUs);
+
+	static void intkISR();
+	static void intiISR();
+
+	static MAX7360EventStream *instance;
+
+	MAX7360 &chip;
+	pin_t intkPin;
+	pin_t intiPin;
+	uint8_t portMask = 0;
+	bool rotary = false;
+
+	volatile bool intkPending = false;
+	volatile uint32_t intkTimeUs = 0;
+	volatile bool intiPending = false;
+	volatile uint32_t intiTimeUs = 0;
+
+	uint8_t lastInputs = 0;
+	uint8_t lastPressedKey = MAX7360Key::FIFO_KEY_NONE;
+	uint64_t lastEventUs = 0;
+	uint32_t lastMicros = 0;
+	uint64_t microsHigh = 0;
+
+	MAX7360RingBuffer<MAX7360Event, EVENT_QUEUE_SIZE> queue;
+};
+
+#endif /* __MAX7360EVENTSTREAM_H */
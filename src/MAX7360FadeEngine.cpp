@@ -0,0 +1,210 @@
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+
+#include "MAX7360FadeEngine.h"
+#include "MAX7360Color.h"
+
+#if MAX7360_ENABLE_LED
+
+// 2^(10 * (x - 1)) at x = 0, 1/16, ..., 1, scaled to 65535
+static const uint16_t _exponentialTable[17] = {
+	0, 99, 152, 235, 362, 558, 861, 1328, 2048, 3158, 4871, 7512, 11585, 17867, 27554, 42494, 65535
+};
+
+MAX7360FadeEngine::MAX7360FadeEngine(MAX7360 &chip) : chip(chip) {
+	memset(ports, 0, sizeof(ports));
+}
+
+MAX7360FadeEngine::~MAX7360FadeEngine() {
+
+}
+
+MAX7360FadeEngine &MAX7360FadeEngine::withMaxWritesPerSecond(unsigned int writesPerSecond) {
+	minFrameMs = (writesPerSecond > 0) ? (1000 / writesPerSecond) : 0;
+	return *this;
+}
+
+bool MAX7360FadeEngine::fadeTo(uint8_t port, uint8_t to, unsigned long durationMs, MAX7360Easing easing) {
+	if (port >= NUM_PORTS) {
+		return false;
+	}
+	return fade(port, ports[port].value, to, durationMs, easing);
+}
+
+bool MAX7360FadeEngine::fade(uint8_t port, uint8_t from, uint8_t to, unsigned long durationMs, MAX7360Easing easing, const uint8_t *customTable, size_t customTableSize) {
+	if (port >= NUM_PORTS) {
+		return false;
+	}
+	if (easing == MAX7360Easing::CUSTOM && (!customTable || customTableSize < 2)) {
+		return false;
+	}
+
+	PortState &state = ports[port];
+	state.from = from;
+	state.to = to;
+	state.easing = easing;
+	state.startMs = millis();
+	state.durationMs = durationMs;
+	state.customTable = customTable;
+	state.customTableSize = customTableSize;
+	state.active = true;
+
+	return true;
+}
+
+void MAX7360FadeEngine::stop(uint8_t port) {
+	if (port < NUM_PORTS) {
+		ports[port].active = false;
+	}
+}
+
+bool MAX7360FadeEngine::isBusy() const {
+	for(size_t ii = 0; ii < NUM_PORTS; ii++) {
+		if (ports[ii].active) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void MAX7360FadeEngine::loop() {
+	if (!isBusy()) {
+		return;
+	}
+
+	unsigned long now = millis();
+	if (frameCount != 0 && now - lastFrameMs < minFrameMs) {
+		// Over the write budget, drop this frame. The next one will catch up.
+		droppedFrameCount++;
+		return;
+	}
+
+	// Calculate the new values
+	uint8_t changedMask = 0;
+	for(size_t ii = 0; ii < NUM_PORTS; ii++) {
+		PortState &state = ports[ii];
+		if (!state.active) {
+			continue;
+		}
+
+		unsigned long elapsed = now - state.startMs;
+		uint8_t value;
+		if (elapsed >= state.durationMs) {
+			value = state.to;
+			state.active = false;
+		}
+		else {
+			uint16_t progress = (uint16_t)(((uint64_t)elapsed << 16) / state.durationMs);
+			int32_t eased = ease(state.easing, progress, state.customTable, state.customTableSize);
+			value = (uint8_t)(state.from + (((int32_t)state.to - (int32_t)state.from) * eased) / 65535);
+		}
+
+		if (!state.known || value != state.value) {
+			state.value = value;
+			changedMask |= (1 << ii);
+		}
+	}
+	if (changedMask == 0) {
+		return;
+	}
+
+	// Write the changed ports in as few bursts as possible. An unchanged port between two changed
+	// ports is only included if its current value is in the register cache, so a value set since
+	// then by something else (setPortPwmRatio, MAX7360RGBLed, ...) is not overwritten.
+	uint8_t ratios[NUM_PORTS];
+	uint8_t runStart = 0;
+	size_t runLength = 0;
+	uint8_t last = (uint8_t) (31 - __builtin_clz(changedMask));
+	for(uint8_t ii = (uint8_t) __builtin_ctz(changedMask); ii <= last + 1; ii++) {
+		bool include = false;
+		if (ii <= last) {
+			if ((changedMask & (1 << ii)) != 0) {
+				ratios[ii] = toRatio(ports[ii].value);
+				ports[ii].known = true;
+				include = true;
+			}
+			else
+			if (runLength > 0) {
+				include = chip.getCachedRegister(MAX7360::REG_PORT_PWM_RATIO + ii, ratios[ii]);
+			}
+		}
+
+		if (include) {
+			if (runLength == 0) {
+				runStart = ii;
+			}
+			runLength++;
+		}
+		else
+		if (runLength > 0) {
+			// Trailing unchanged ports don't need to be written
+			while((changedMask & (1 << (runStart + runLength - 1))) == 0) {
+				runLength--;
+			}
+			chip.writeRegisters(MAX7360::REG_PORT_PWM_RATIO + runStart, &ratios[runStart], runLength);
+			runLength = 0;
+		}
+	}
+
+	lastFrameMs = now;
+	frameCount++;
+}
+
+uint16_t MAX7360FadeEngine::ease(MAX7360Easing easing, uint16_t progress, const uint8_t *customTable, size_t customTableSize) {
+	uint32_t p = progress;
+	uint32_t inv = 65535 - p;
+
+	switch(easing) {
+	case MAX7360Easing::LINEAR:
+	default:
+		return progress;
+
+	case MAX7360Easing::EASE_IN:
+		return (uint16_t)((p * p) / 65535);
+
+	case MAX7360Easing::EASE_OUT:
+		return (uint16_t)(65535 - (inv * inv) / 65535);
+
+	case MAX7360Easing::EASE_IN_OUT:
+		if (p < 32768) {
+			return (uint16_t)((2 * p * p) / 65535);
+		}
+		else {
+			return (uint16_t)(65535 - (2 * inv * inv) / 65535);
+		}
+
+	case MAX7360Easing::EXPONENTIAL: {
+		// Linear interpolation between 17 points
+		uint32_t index = p >> 12;
+		uint32_t frac = p & 0xfff;
+		if (index >= 16) {
+			return _exponentialTable[16];
+		}
+		uint32_t a = _exponentialTable[index];
+		uint32_t b = _exponentialTable[index + 1];
+		return (uint16_t)(a + (((b - a) * frac) >> 12));
+	}
+
+	case MAX7360Easing::CUSTOM: {
+		if (!customTable || customTableSize < 2) {
+			return progress;
+		}
+		// Linear interpolation between table entries, scaled from 0 - 255 to 0 - 65535
+		uint32_t pos = p * (customTableSize - 1);
+		uint32_t index = pos / 65535;
+		uint32_t frac = pos % 65535;
+		if (index >= customTableSize - 1) {
+			return customTable[customTableSize - 1] * 257;
+		}
+		int32_t a = customTable[index] * 257;
+		int32_t b = customTable[index + 1] * 257;
+		return (uint16_t)(a + ((b - a) * (int32_t)(frac >> 1)) / (65535 >> 1));
+	}
+	}
+}
+
+uint8_t MAX7360FadeEngine::toRatio(uint8_t value) const {
+	return gammaEnabled ? MAX7360Color::gamma(value) : value;
+}
+
+#endif /* MAX7360_ENABLE_LED */
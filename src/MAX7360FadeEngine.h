@@ -0,0 +1,168 @@
+#ifndef __MAX7360FADEENGINE_H
+#define __MAX7360FADEENGINE_H
+
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+
+#include "MAX7360-RK.h"
+
+#if MAX7360_ENABLE_LED
+
+/**
+ * @brief Easing curve for a fade
+ */
+enum class MAX7360Easing : uint8_t {
+	LINEAR,				//!< Constant rate
+	EASE_IN,			//!< Starts slow, speeds up (quadratic)
+	EASE_OUT,			//!< Starts fast, slows down (quadratic)
+	EASE_IN_OUT,		//!< Slow at both ends (quadratic)
+	EXPONENTIAL,		//!< Exponential ease in, very slow start
+	CUSTOM				//!< Custom table passed to fade()
+};
+
+/**
+ * @brief Host-side fade engine for the PWM ports
+ *
+ * The chip's hardware fade (setConfigFadeTime) is linear, only supports a few fixed times, and
+ * applies to all ports. This class fades each port independently with any duration and easing
+ * curve by updating the port PWM ratio registers from loop().
+ *
+ * To keep fades from using up the I2C bus, the number of frames written per second is limited
+ * (default: 50). When loop() is called more often than that, intermediate frames are dropped,
+ * not queued, so the next frame written is always the current value. Adjacent ports that change
+ * in a frame are written in one burst transaction. Ports that are not fading are never written,
+ * except to join two bursts when their current value is in the register cache.
+ *
+ * The ports must be outputs (setGpioInputOutputMode), GPIO must be enabled (setConfigEnableGpio),
+ * and the ports should be in individual PWM mode (the default) with the hardware fade disabled.
+ */
+class MAX7360FadeEngine {
+public:
+	/**
+	 * @brief Construct a fade engine
+	 *
+	 * @param chip The MAX7360 object
+	 */
+	MAX7360FadeEngine(MAX7360 &chip);
+	virtual ~MAX7360FadeEngine();
+
+	/**
+	 * @brief Maximum number of frames (I2C transactions) per second (default: 50)
+	 */
+	MAX7360FadeEngine &withMaxWritesPerSecond(unsigned int writesPerSecond);
+
+	/**
+	 * @brief Apply gamma correction (MAX7360Color::gamma) to the fade values (default: false)
+	 *
+	 * With gamma correction, from and to are perceptual brightness, not PWM ratios.
+	 */
+	MAX7360FadeEngine &withGamma(bool enable = true) { gammaEnabled = enable; return *this; };
+
+	/**
+	 * @brief Start a fade on a port. Replaces any fade in progress on that port.
+	 *
+	 * @param port Port number 0 - 7
+	 *
+	 * @param from Starting value 0 - 255
+	 *
+	 * @param to Ending value 0 - 255
+	 *
+	 * @param durationMs Fade duration in milliseconds
+	 *
+	 * @param easing Easing curve (default: LINEAR)
+	 *
+	 * @param customTable For CUSTOM easing, the curve as values 0 (from) to 255 (to), evenly spaced in time.
+	 * Must have at least 2 entries and remain valid until the fade completes.
+	 *
+	 * @param customTableSize Number of entries in customTable
+	 */
+	bool fade(uint8_t port, uint8_t from, uint8_t to, unsigned long durationMs, MAX7360Easing easing = MAX7360Easing::LINEAR, const uint8_t *customTable = 0, size_t customTableSize = 0);
+
+	/**
+	 * @brief Fade from the last value written to the port
+	 *
+	 * Returns false if port is not 0 - 7.
+	 */
+	bool fadeTo(uint8_t port, uint8_t to, unsigned long durationMs, MAX7360Easing easing = MAX7360Easing::LINEAR);
+
+	/**
+	 * @brief Stop fading a port, leaving it at its current value
+	 */
+	void stop(uint8_t port);
+
+	/**
+	 * @brief Returns true if the port is fading
+	 */
+	bool isFading(uint8_t port) const { return port < NUM_PORTS && ports[port].active; };
+
+	/**
+	 * @brief Returns true if any port is fading
+	 */
+	bool isBusy() const;
+
+	/**
+	 * @brief Call from loop() to update the fades
+	 */
+	void loop();
+
+	/**
+	 * @brief Number of frames written
+	 */
+	uint32_t getFrameCount() const { return frameCount; };
+
+	/**
+	 * @brief Number of loop() calls that skipped a frame because of the write rate limit
+	 */
+	uint32_t getDroppedFrameCount() const { return droppedFrameCount; };
+
+	/**
+	 * @brief Ease a progress value
+	 *
+	 * @param easing The easing curve
+	 *
+	 * @param progress Progress from 0 to 65535
+	 *
+	 * @param customTable For CUSTOM, the curve table
+	 *
+	 * @param customTableSize For CUSTOM, the number of entries in the table
+	 *
+	 * @return The eased progress from 0 to 65535
+	 */
+	static uint16_t ease(MAX7360Easing easing, uint16_t progress, const uint8_t *customTable = 0, size_t customTableSize = 0);
+
+	static const size_t NUM_PORTS = 8;		//!< PORT0 - PORT7
+
+protected:
+	/**
+	 * @brief Fade state for one port
+	 */
+	struct PortState {
+		bool active;				//!< Fade in progress
+		bool known;					//!< value is what's in the chip
+		uint8_t from;
+		uint8_t to;
+		uint8_t value;				//!< Last value written (before gamma correction)
+		MAX7360Easing easing;
+		unsigned long startMs;
+		unsigned long durationMs;
+		const uint8_t *customTable;
+		size_t customTableSize;
+	};
+
+	/**
+	 * @brief Ratio to write to the chip for a value, applying gamma correction if enabled
+	 */
+	uint8_t toRatio(uint8_t value) const;
+
+	MAX7360 &chip;
+	PortState ports[NUM_PORTS];
+	unsigned long minFrameMs = 20;
+	unsigned long lastFrameMs = 0;
+	bool gammaEnabled = false;
+	uint32_t frameCount = 0;
+	uint32_t droppedFrameCount = 0;
+};
+
+#endif /* MAX7360_ENABLE_LED */
+
+#endif /* __MAX7360FADEENGINE_H */
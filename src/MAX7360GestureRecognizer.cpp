@@ -0,0 +1,140 @@
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+
+#include "MAX7360GestureRecognizer.h"
+
+#if MAX7360_ENABLE_KEYPAD
+
+MAX7360GestureRecognizer::MAX7360GestureRecognizer() {
+	reset();
+}
+
+MAX7360GestureRecognizer::~MAX7360GestureRecognizer() {
+
+}
+
+void MAX7360GestureRecognizer::processKey(const MAX7360Key &key, unsigned long timeMs) {
+	// Catch any long press that loop() hasn't seen yet, so it's ordered before this key
+	loop(timeMs);
+
+	if (key.isKeyRepeat()) {
+		if (lastPressedKey >= 64) {
+			return;
+		}
+		repeatCount += key.getRepeatCount();
+
+		// Coalesce into the previous event if it's a repeat of the same key
+		MAX7360GestureEvent *last = events.back();
+		if (last && last->type == MAX7360GestureType::HOLD_REPEAT && last->rawKey == lastPressedKey) {
+			last->repeatCount = repeatCount;
+			last->timeMs = timeMs;
+		}
+		else {
+			addEvent(MAX7360GestureType::HOLD_REPEAT, lastPressedKey, timeMs);
+		}
+		return;
+	}
+
+	if (key.isOverflow()) {
+		// Presses and releases were lost, so which keys are held is unknown
+		clearKeyState();
+		return;
+	}
+
+	uint8_t rawKey = key.getRawKey();
+	if (rawKey >= 64) {
+		// Empty
+		return;
+	}
+	uint64_t bit = 1ULL << rawKey;
+
+	if (!key.isReleased()) {
+		pressedMask |= bit;
+		chordMask |= bit;
+		longPressMask &= ~bit;
+		pressTime[rawKey] = timeMs;
+		lastPressedKey = rawKey;
+		repeatCount = 0;
+		return;
+	}
+
+	if ((pressedMask & bit) == 0) {
+		// Release without a press (press was before we started, or was lost to FIFO overflow)
+		return;
+	}
+	pressedMask &= ~bit;
+
+	bool wasLong = (longPressMask & bit) != 0;
+	longPressMask &= ~bit;
+
+	if (rawKey == lastPressedKey) {
+		lastPressedKey = MAX7360Key::FIFO_KEY_NONE;
+	}
+
+	if (pressedMask != 0) {
+		// Still part of a chord
+		return;
+	}
+
+	if ((chordMask & (chordMask - 1)) != 0) {
+		// More than one key was held
+		addEvent(MAX7360GestureType::CHORD_RELEASE, rawKey, timeMs, chordMask);
+		lastTapKey = MAX7360Key::FIFO_KEY_NONE;
+	}
+	else
+	if (!wasLong) {
+		if (rawKey == lastTapKey && timeMs - lastTapTime <= doubleTapMs) {
+			addEvent(MAX7360GestureType::DOUBLE_TAP, rawKey, timeMs);
+			lastTapKey = MAX7360Key::FIFO_KEY_NONE;
+		}
+		else {
+			addEvent(MAX7360GestureType::TAP, rawKey, timeMs);
+			lastTapKey = rawKey;
+			lastTapTime = timeMs;
+		}
+	}
+	else {
+		lastTapKey = MAX7360Key::FIFO_KEY_NONE;
+	}
+	chordMask = 0;
+}
+
+void MAX7360GestureRecognizer::loop(unsigned long timeMs) {
+	uint64_t candidates = pressedMask & ~longPressMask;
+
+	while(candidates) {
+		uint8_t rawKey = (uint8_t) __builtin_ctzll(candidates);
+		uint64_t bit = 1ULL << rawKey;
+		candidates &= ~bit;
+
+		if (timeMs - pressTime[rawKey] >= longPressMs) {
+			longPressMask |= bit;
+			addEvent(MAX7360GestureType::LONG_PRESS, rawKey, timeMs);
+		}
+	}
+}
+
+void MAX7360GestureRecognizer::reset() {
+	events.clear();
+	clearKeyState();
+}
+
+void MAX7360GestureRecognizer::clearKeyState() {
+	pressedMask = longPressMask = chordMask = 0;
+	lastPressedKey = lastTapKey = MAX7360Key::FIFO_KEY_NONE;
+	repeatCount = 0;
+	memset(pressTime, 0, sizeof(pressTime));
+}
+
+void MAX7360GestureRecognizer::addEvent(MAX7360GestureType type, uint8_t rawKey, unsigned long timeMs, uint64_t chordMask) {
+	MAX7360GestureEvent event;
+	event.type = type;
+	event.rawKey = rawKey;
+	event.repeatCount = repeatCount;
+	event.chordMask = chordMask;
+	event.timeMs = timeMs;
+
+	events.push(event);
+}
+
+#endif /* MAX7360_ENABLE_KEYPAD */
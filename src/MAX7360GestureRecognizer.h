@@ -0,0 +1,144 @@
+#ifndef __MAX7360GESTURERECOGNIZER_H
+#define __MAX7360GESTURERECOGNIZER_H
+
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+
+#include "MAX7360-RK.h"
+#include "MAX7360RingBuffer.h"
+
+#if MAX7360_ENABLE_KEYPAD
+
+/**
+ * @brief Type of gesture in a MAX7360GestureEvent
+ */
+enum class MAX7360GestureType : uint8_t {
+	TAP,				//!< Key pressed and released, shorter than the long-press time
+	DOUBLE_TAP,			//!< Second tap of the same key within the double-tap time
+	LONG_PRESS,			//!< Key held for the long-press time (reported once, while still held)
+	HOLD_REPEAT,		//!< Key held with auto-repeat. repeatCount is the number of repeats so far.
+	CHORD_RELEASE		//!< Two or more keys were held together and all have been released
+};
+
+/**
+ * @brief A gesture recognized by MAX7360GestureRecognizer
+ */
+struct MAX7360GestureEvent {
+	MAX7360GestureType type;		//!< The kind of gesture
+	uint8_t rawKey;					//!< Raw key 0 - 63. For CHORD_RELEASE it's the last key released.
+	uint16_t repeatCount;			//!< For HOLD_REPEAT, number of repeats since the key was pressed
+	uint64_t chordMask;				//!< For CHORD_RELEASE, bit n is set if KEYn was part of the chord
+	unsigned long timeMs;			//!< Time the gesture was recognized (millis)
+};
+
+/**
+ * @brief Recognizes long-press, double-tap, hold-with-repeat, and chord gestures from FIFO key events
+ *
+ * Key release events must be enabled (the power-on default) for anything other than HOLD_REPEAT
+ * to work. Auto-repeat must be enabled for HOLD_REPEAT events.
+ *
+ * Pass every key read from the FIFO to processKey() and call loop() from loop(); long presses
+ * are detected in loop() while the key is still down. Gestures are read using getEvent().
+ *
+ * Auto-repeat codes for a held key are coalesced: if the most recent event in the queue is
+ * a HOLD_REPEAT for the same key, its count is updated instead of adding another event,
+ * so a held key produces at most one queued event no matter how long it's held.
+ *
+ * A TAP is reported when the key is released, even if it later turns out to be the first
+ * half of a DOUBLE_TAP. This avoids delaying every tap by the double-tap time.
+ *
+ * If the FIFO overflows, the held keys are forgotten, since presses and releases were lost.
+ * Events already in the queue are kept. Keys held through the overflow don't generate gestures.
+ *
+ * All of the methods that take a timeMs parameter also have a version that uses millis(),
+ * the explicit version is for replaying recorded key traces.
+ */
+class MAX7360GestureRecognizer {
+public:
+	MAX7360GestureRecognizer();
+	virtual ~MAX7360GestureRecognizer();
+
+	/**
+	 * @brief How long a key must be held to generate a LONG_PRESS (default: 800 ms)
+	 */
+	MAX7360GestureRecognizer &withLongPressMs(unsigned long ms) { longPressMs = ms; return *this; };
+
+	/**
+	 * @brief Maximum time between the first release and second release for a DOUBLE_TAP (default: 400 ms)
+	 */
+	MAX7360GestureRecognizer &withDoubleTapMs(unsigned long ms) { doubleTapMs = ms; return *this; };
+
+	/**
+	 * @brief Process a key read from the FIFO
+	 */
+	void processKey(const MAX7360Key &key) { processKey(key, millis()); };
+
+	/**
+	 * @brief Process a key read from the FIFO at the specified time
+	 */
+	void processKey(const MAX7360Key &key, unsigned long timeMs);
+
+	/**
+	 * @brief Call from loop() to detect long presses
+	 */
+	void loop() { loop(millis()); };
+
+	/**
+	 * @brief Detect long presses as of the specified time
+	 */
+	void loop(unsigned long timeMs);
+
+	/**
+	 * @brief Get the next gesture event
+	 *
+	 * @return true if an event was copied into event, false if there are no events
+	 */
+	bool getEvent(MAX7360GestureEvent &event) { return events.pop(event); };
+
+	/**
+	 * @brief Returns true if there are events waiting to be read with getEvent()
+	 */
+	bool hasEvent() const { return !events.isEmpty(); };
+
+	/**
+	 * @brief Number of events discarded because the queue was full
+	 */
+	size_t getDropCount() const { return events.getDropCount(); };
+
+	/**
+	 * @brief Bitmask of keys currently held down (bit n = KEYn)
+	 */
+	uint64_t getPressedMask() const { return pressedMask; };
+
+	/**
+	 * @brief Clear all key state and queued events
+	 */
+	void reset();
+
+	static const size_t EVENT_QUEUE_SIZE = 16;		//!< Maximum number of events waiting to be read
+
+protected:
+	/**
+	 * @brief Clear the held key, long-press, chord, and tap state, but not the queued events
+	 */
+	void clearKeyState();
+
+	void addEvent(MAX7360GestureType type, uint8_t rawKey, unsigned long timeMs, uint64_t chordMask = 0);
+
+	MAX7360RingBuffer<MAX7360GestureEvent, EVENT_QUEUE_SIZE> events;
+	unsigned long longPressMs = 800;
+	unsigned long doubleTapMs = 400;
+
+	uint64_t pressedMask = 0;			//!< Keys currently held
+	uint64_t longPressMask = 0;			//!< Held keys that have already generated LONG_PRESS
+	uint64_t chordMask = 0;				//!< All keys pressed since the last time no keys were held
+	unsigned long pressTime[64];		//!< Time each held key was pressed
+	uint8_t lastPressedKey = MAX7360Key::FIFO_KEY_NONE;
+	uint16_t repeatCount = 0;			//!< Repeats of lastPressedKey
+	uint8_t lastTapKey = MAX7360Key::FIFO_KEY_NONE;
+	unsigned long lastTapTime = 0;
+};
+
+#endif /* MAX7360_ENABLE_KEYPAD */
+
+#endif /* __MAX7360GESTURERECOGNIZER_H */
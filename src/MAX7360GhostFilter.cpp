@@ -0,0 +1,107 @@
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+
+#include "MAX7360GhostFilter.h"
+
+#if MAX7360_ENABLE_KEYPAD
+
+MAX7360GhostFilter::MAX7360GhostFilter(uint8_t numRows, uint8_t numCols) : numRows(numRows), numCols(numCols) {
+	if (this->numRows > 8) {
+		this->numRows = 8;
+	}
+	if (this->numCols > 8) {
+		this->numCols = 8;
+	}
+	reset();
+}
+
+MAX7360GhostFilter::~MAX7360GhostFilter() {
+
+}
+
+MAX7360GhostStatus MAX7360GhostFilter::process(const MAX7360Key &key) {
+	if (key.isOverflow()) {
+		reset();
+		return MAX7360GhostStatus::OK;
+	}
+
+	if (key.isKeyRepeat()) {
+		return lastPressGhost ? ghostStatus() : MAX7360GhostStatus::OK;
+	}
+
+	if (!key.hasKey()) {
+		return MAX7360GhostStatus::OK;
+	}
+
+	uint8_t col = key.getRawKey() >> 3;
+	uint8_t row = key.getRawKey() & 0x7;
+	uint8_t rowBit = 1 << row;
+
+	if (key.isReleased()) {
+		colRows[col] &= ~rowBit;
+		rowCols[row] &= ~(1 << col);
+
+		if (ghostRows[col] & rowBit) {
+			ghostRows[col] &= ~rowBit;
+			return ghostStatus();
+		}
+		return MAX7360GhostStatus::OK;
+	}
+
+	bool ghost = (col >= numCols || row >= numRows) || (!hasDiodes && completesRectangle(col, row));
+
+	colRows[col] |= rowBit;
+	rowCols[row] |= (1 << col);
+	lastPressGhost = ghost;
+
+	if (ghost) {
+		ghostRows[col] |= rowBit;
+		ghostCount++;
+		return ghostStatus();
+	}
+	return MAX7360GhostStatus::OK;
+}
+
+void MAX7360GhostFilter::reset() {
+	memset(colRows, 0, sizeof(colRows));
+	memset(rowCols, 0, sizeof(rowCols));
+	memset(ghostRows, 0, sizeof(ghostRows));
+	lastPressGhost = false;
+}
+
+bool MAX7360GhostFilter::isPressed(uint8_t rawKey) const {
+	if (rawKey >= 64) {
+		return false;
+	}
+	return (colRows[rawKey >> 3] & (1 << (rawKey & 0x7))) != 0;
+}
+
+uint8_t MAX7360GhostFilter::getPressedCount() const {
+	uint8_t count = 0;
+	for(size_t col = 0; col < 8; col++) {
+		for(uint8_t rows = colRows[col]; rows; rows &= rows - 1) {
+			count++;
+		}
+	}
+	return count;
+}
+
+bool MAX7360GhostFilter::completesRectangle(uint8_t col, uint8_t row) const {
+	// Other rows pressed in this column
+	uint8_t rowsInCol = colRows[col] & ~(1 << row);
+	if (!rowsInCol) {
+		return false;
+	}
+
+	// Other columns pressed in this row. If any of them also has one of rowsInCol pressed,
+	// the four keys make a rectangle.
+	for(uint8_t cols = rowCols[row] & ~(1 << col); cols; cols &= cols - 1) {
+		uint8_t otherCol = __builtin_ctz(cols);
+		if (colRows[otherCol] & rowsInCol) {
+			return true;
+		}
+	}
+	return false;
+}
+
+#endif /* MAX7360_ENABLE_KEYPAD */
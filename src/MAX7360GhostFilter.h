@@ -0,0 +1,139 @@
+#ifndef __MAX7360GHOSTFILTER_H
+#define __MAX7360GHOSTFILTER_H
+
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+
+#include "MAX7360-RK.h"
+
+#if MAX7360_ENABLE_KEYPAD
+
+/**
+ * @brief What MAX7360GhostFilter does with a key that could be a ghost
+ */
+enum class MAX7360GhostMode : uint8_t {
+	FLAG,				//!< Pass the key through, but process() returns GHOST
+	SUPPRESS			//!< process() returns SUPPRESSED and the key should be ignored
+};
+
+/**
+ * @brief Result of MAX7360GhostFilter::process()
+ */
+enum class MAX7360GhostStatus : uint8_t {
+	OK,					//!< Normal key event
+	GHOST,				//!< Could be a ghost (FLAG mode)
+	SUPPRESSED			//!< Could be a ghost and should be ignored (SUPPRESS mode)
+};
+
+/**
+ * @brief Detects keys that could be ghosting artifacts in a key matrix without diodes
+ *
+ * In a passive matrix, when three keys on three corners of a rectangle are held down, current
+ * flows through them to the fourth corner and it appears to be pressed as well. The chip can't
+ * tell the difference, so it puts the phantom key in the FIFO.
+ *
+ * This filter keeps the pressed state of the matrix from the FIFO events as a bitmask per column
+ * and per row. When a key is pressed, it's a possible ghost if it completes a rectangle with
+ * three keys that are already down. The check is a few bitwise operations over at most 8 columns,
+ * regardless of how many keys are down.
+ *
+ * The release of a key whose press was flagged or suppressed gets the same status, as do the
+ * auto-repeat codes while it's the last key pressed, so the application doesn't see half of a
+ * ghost.
+ *
+ * Raw key numbers are column * 8 + row (see MAX7360KeyMappingTable). A key outside the
+ * configured number of rows and columns can't exist on the keypad, so it's treated as a ghost.
+ */
+class MAX7360GhostFilter {
+public:
+	/**
+	 * @brief Construct a ghost filter
+	 *
+	 * @param numRows Number of rows in the keypad matrix, 1 - 8 (ROW0 - ROWn-1)
+	 *
+	 * @param numCols Number of columns in the keypad matrix, 1 - 8 (COL0 - COLn-1)
+	 */
+	MAX7360GhostFilter(uint8_t numRows = 8, uint8_t numCols = 8);
+	virtual ~MAX7360GhostFilter();
+
+	/**
+	 * @brief Set whether possible ghosts are flagged or suppressed (default: SUPPRESS)
+	 */
+	MAX7360GhostFilter &withMode(MAX7360GhostMode mode) { this->mode = mode; return *this; };
+
+	/**
+	 * @brief Set whether the keypad has a diode in series with each key (default: false)
+	 *
+	 * With diodes there's no ghosting, so no keys are flagged (keys outside the matrix still are)
+	 * and the effective rollover is the number of keys.
+	 */
+	MAX7360GhostFilter &withDiodes(bool hasDiodes = true) { this->hasDiodes = hasDiodes; return *this; };
+
+	/**
+	 * @brief Process a key event read from the FIFO
+	 *
+	 * Call this for every event, in order, including releases (enable key release events in the
+	 * chip with setConfigurationEnableKeyRelease(true), otherwise the pressed state can't be tracked).
+	 */
+	MAX7360GhostStatus process(const MAX7360Key &key);
+
+	/**
+	 * @brief Returns true if the key should be used (process() did not return SUPPRESSED)
+	 */
+	bool accept(const MAX7360Key &key) { return process(key) != MAX7360GhostStatus::SUPPRESSED; };
+
+	/**
+	 * @brief Clear the pressed key state
+	 *
+	 * This is done automatically on FIFO overflow, since events have been lost.
+	 */
+	void reset();
+
+	/**
+	 * @brief Returns true if the key is down, according to the events processed so far (including ghosts)
+	 */
+	bool isPressed(uint8_t rawKey) const;
+
+	/**
+	 * @brief Number of keys down, including ghosts
+	 */
+	uint8_t getPressedCount() const;
+
+	/**
+	 * @brief Number of key presses that were flagged or suppressed since construction
+	 */
+	uint32_t getGhostCount() const { return ghostCount; };
+
+	/**
+	 * @brief Number of simultaneous keys that are always reported correctly
+	 *
+	 * Without diodes, any three keys can make an L shape, so only 2-key rollover is guaranteed.
+	 * With diodes, it's the number of keys in the matrix (N-key rollover).
+	 */
+	uint8_t getEffectiveRollover() const { return hasDiodes ? numRows * numCols : 2; };
+
+protected:
+	/**
+	 * @brief Returns true if pressing col, row would complete a rectangle of pressed keys
+	 */
+	bool completesRectangle(uint8_t col, uint8_t row) const;
+
+	/**
+	 * @brief Returns the status for a possible ghost in the current mode
+	 */
+	MAX7360GhostStatus ghostStatus() const { return (mode == MAX7360GhostMode::SUPPRESS) ? MAX7360GhostStatus::SUPPRESSED : MAX7360GhostStatus::GHOST; };
+
+	uint8_t numRows;
+	uint8_t numCols;
+	MAX7360GhostMode mode = MAX7360GhostMode::SUPPRESS;
+	bool hasDiodes = false;
+	uint8_t colRows[8];					//!< For each column, bit mask of rows that are pressed
+	uint8_t rowCols[8];					//!< For each row, bit mask of columns that are pressed
+	uint8_t ghostRows[8];				//!< For each column, bit mask of rows pressed as possible ghosts
+	bool lastPressGhost = false;		//!< The last key pressed was a possible ghost (applies to repeat codes)
+	uint32_t ghostCount = 0;
+};
+
+#endif /* MAX7360_ENABLE_KEYPAD */
+
+#endif /* __MAX7360GHOSTFILTER_H */
@@ -0,0 +1,157 @@
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+
+#include "MAX7360GpioExpander.h"
+
+#if MAX7360_ENABLE_GPIO
+
+MAX7360GpioExpander::MAX7360GpioExpander(MAX7360 &chip) : chip(chip) {
+	memset(pwm, 0, sizeof(pwm));
+}
+
+MAX7360GpioExpander::~MAX7360GpioExpander() {
+
+}
+
+bool MAX7360GpioExpander::begin() {
+	bool result = chip.setConfigEnableGpio(true);
+
+	direction = chip.readRegister(MAX7360::REG_GPIO_CONTROL);
+	result = chip.readRegisters(MAX7360::REG_PORT_PWM_RATIO, pwm, sizeof(pwm)) && result;
+
+	dirtyPwm = 0;
+	dirtyDirection = false;
+	inputsValid = false;
+
+	return result;
+}
+
+bool MAX7360GpioExpander::reload() {
+	uint8_t chipDirection;
+	uint8_t chipPwm[8];
+
+	bool result = chip.readRegisters(MAX7360::REG_GPIO_CONTROL, &chipDirection, 1);
+	result = chip.readRegisters(MAX7360::REG_PORT_PWM_RATIO, chipPwm, sizeof(chipPwm)) && result;
+	if (!result) {
+		return false;
+	}
+
+	// Changes not flushed yet are kept, they'll be written by the next flush()
+	if (!dirtyDirection) {
+		direction = chipDirection;
+	}
+	for(size_t ii = 0; ii < 8; ii++) {
+		if ((dirtyPwm & (1 << ii)) == 0) {
+			pwm[ii] = chipPwm[ii];
+		}
+	}
+	inputsValid = false;
+
+	return true;
+}
+
+void MAX7360GpioExpander::pinMode(uint8_t pin, PinMode mode) {
+	if (pin >= 8) {
+		return;
+	}
+	uint8_t newDirection = direction;
+	if (mode == OUTPUT) {
+		newDirection |= (1 << pin);
+	}
+	else {
+		newDirection &= ~(1 << pin);
+	}
+	if (newDirection != direction) {
+		direction = newDirection;
+		dirtyDirection = true;
+	}
+}
+
+void MAX7360GpioExpander::analogWrite(uint8_t pin, uint8_t value) {
+	if (pin >= 8 || pwm[pin] == value) {
+		return;
+	}
+	pwm[pin] = value;
+	dirtyPwm |= (1 << pin);
+}
+
+uint8_t MAX7360GpioExpander::digitalRead(uint8_t pin, unsigned long maxAgeMs) {
+	if (pin >= 8) {
+		return LOW;
+	}
+	if (direction & (1 << pin)) {
+		return (pwm[pin] != 0) ? HIGH : LOW;
+	}
+	return (readInputs(maxAgeMs) & (1 << pin)) ? HIGH : LOW;
+}
+
+uint8_t MAX7360GpioExpander::readInputs(unsigned long maxAgeMs) {
+	if (!inputsValid || millis() - inputsTime > maxAgeMs) {
+		inputs = chip.readGpioInputs();
+		inputsTime = millis();
+		inputsValid = true;
+	}
+	return inputs;
+}
+
+bool MAX7360GpioExpander::flush() {
+	bool result = true;
+
+	if (dirtyPwm) {
+		// Write each run of adjacent dirty ports as one burst. An unchanged port between two dirty
+		// ports is only included if its current value is in the register cache; the pwm shadow is
+		// not used for it, since something else (MAX7360RGBLed, MAX7360FadeEngine, ...) may have
+		// changed it.
+		uint8_t values[8];
+		uint8_t runStart = 0;
+		size_t runLength = 0;
+		uint8_t last = (uint8_t) (31 - __builtin_clz(dirtyPwm));
+		for(uint8_t ii = (uint8_t) __builtin_ctz(dirtyPwm); ii <= last + 1; ii++) {
+			bool include = false;
+			if (ii <= last) {
+				if ((dirtyPwm & (1 << ii)) != 0) {
+					values[ii] = pwm[ii];
+					include = true;
+				}
+				else
+				if (runLength > 0) {
+					include = chip.getCachedRegister(MAX7360::REG_PORT_PWM_RATIO + ii, values[ii]);
+				}
+			}
+
+			if (include) {
+				if (runLength == 0) {
+					runStart = ii;
+				}
+				runLength++;
+			}
+			else
+			if (runLength > 0) {
+				// Trailing unchanged ports don't need to be written
+				while((dirtyPwm & (1 << (runStart + runLength - 1))) == 0) {
+					runLength--;
+				}
+				if (chip.writeRegisters(MAX7360::REG_PORT_PWM_RATIO + runStart, &values[runStart], runLength)) {
+					dirtyPwm &= ~(((1 << runLength) - 1) << runStart);
+				}
+				else {
+					result = false;
+				}
+				runLength = 0;
+			}
+		}
+	}
+
+	if (dirtyDirection) {
+		if (chip.setGpioInputOutputMode(direction)) {
+			dirtyDirection = false;
+		}
+		else {
+			result = false;
+		}
+	}
+
+	return result;
+}
+
+#endif /* MAX7360_ENABLE_GPIO */
@@ -0,0 +1,141 @@
+#ifndef __MAX7360GPIOEXPANDER_H
+#define __MAX7360GPIOEXPANDER_H
+
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+
+#include "MAX7360-RK.h"
+
+#if MAX7360_ENABLE_GPIO
+
+/**
+ * @brief Arduino-style per-pin API for PORT0 - PORT7
+ *
+ * Pin numbers are the port numbers 0 - 7. The direction and output state of each pin are kept
+ * in this object, so pinMode(), digitalWrite(), and analogWrite() don't read the chip. They
+ * also don't write it; changes are collected and sent by flush(), which you normally call from
+ * loop(). Adjacent changed PWM ratios are sent in one burst write and the direction register is
+ * written only if it changed, so setting all eight pins costs at most two transactions.
+ *
+ * The ports are open-drain constant-current outputs. HIGH turns the output on (sinking current,
+ * PWM ratio 255) and LOW turns it off (PWM ratio 0), which is the same sense as setPortPwmRatio()
+ * and an LED connected from a supply to the port.
+ *
+ * digitalRead() of an input uses a snapshot of the GPIO input register that is read again only
+ * if it's older than the maximum age, so calling it for several pins, or in a tight loop, doesn't
+ * read the chip each time.
+ */
+class MAX7360GpioExpander {
+public:
+	/**
+	 * @brief Construct a GPIO expander object
+	 *
+	 * @param chip The MAX7360 object
+	 */
+	MAX7360GpioExpander(MAX7360 &chip);
+	virtual ~MAX7360GpioExpander();
+
+	/**
+	 * @brief Set the maximum age of the input snapshot used by digitalRead() (default: 10 ms)
+	 *
+	 * 0 reads the chip on every digitalRead() of an input.
+	 */
+	MAX7360GpioExpander &withMaxReadAgeMs(unsigned long ms) { maxReadAgeMs = ms; return *this; };
+
+	/**
+	 * @brief Enable GPIO operation and load the direction and PWM ratios from the chip
+	 *
+	 * Call this after MAX7360::begin(). It's one write and two reads (one of them a burst).
+	 */
+	bool begin();
+
+	/**
+	 * @brief Load the direction and PWM ratios from the chip again, keeping changes not yet flushed
+	 *
+	 * Use this when the chip registers were changed behind this object's back, for example
+	 * after MAX7360::restore(). MAX7360HealthMonitor calls it after a recovery if you pass this
+	 * object to MAX7360HealthMonitor::withGpioExpander().
+	 */
+	bool reload();
+
+	/**
+	 * @brief Set a pin as INPUT or OUTPUT. Takes effect on the next flush().
+	 *
+	 * @param pin Port number 0 - 7
+	 *
+	 * @param mode INPUT or OUTPUT. There are no pull-up or pull-down options on this chip, so
+	 * INPUT_PULLUP and INPUT_PULLDOWN are the same as INPUT.
+	 */
+	void pinMode(uint8_t pin, PinMode mode);
+
+	/**
+	 * @brief Turn an output on (HIGH) or off (LOW). Takes effect on the next flush().
+	 */
+	void digitalWrite(uint8_t pin, uint8_t value) { analogWrite(pin, value ? 255 : 0); };
+
+	/**
+	 * @brief Set the PWM ratio of an output (0 = off, 255 = fully on). Takes effect on the next flush().
+	 */
+	void analogWrite(uint8_t pin, uint8_t value);
+
+	/**
+	 * @brief Read a pin
+	 *
+	 * For an output, this is the state from the last digitalWrite() or analogWrite() (HIGH if
+	 * the PWM ratio is not 0), without reading the chip. For an input, it's from the input
+	 * snapshot, which is read from the chip if it's older than the maximum age.
+	 */
+	uint8_t digitalRead(uint8_t pin) { return digitalRead(pin, maxReadAgeMs); };
+
+	/**
+	 * @brief Read a pin, with a maximum input snapshot age for this call
+	 */
+	uint8_t digitalRead(uint8_t pin, unsigned long maxAgeMs);
+
+	/**
+	 * @brief Get all of the inputs, from the snapshot if it's not older than maxAgeMs
+	 *
+	 * Bit D0 is PORT0 ... D7 is PORT7, like MAX7360::readGpioInputs().
+	 */
+	uint8_t readInputs(unsigned long maxAgeMs);
+
+	/**
+	 * @brief Discard the input snapshot so the next read gets it from the chip
+	 */
+	void invalidateInputs() { inputsValid = false; };
+
+	/**
+	 * @brief Write pending pin changes to the chip
+	 *
+	 * PWM ratios are written first, one burst per run of adjacent changed ports. Ports that were
+	 * not changed through this object are not written, unless their current value is in the
+	 * register cache and writing it joins two runs. Then the direction register is written if it
+	 * changed, so a pin that becomes an output already has its output level set.
+	 */
+	bool flush();
+
+	/**
+	 * @brief Returns true if there are changes not written by flush() yet
+	 */
+	bool hasPendingChanges() const { return dirtyPwm != 0 || dirtyDirection; };
+
+	/**
+	 * @brief Get the output mask (bit set = output) that will be in the chip after flush()
+	 */
+	uint8_t getDirection() const { return direction; };
+
+protected:
+	MAX7360 &chip;
+	unsigned long maxReadAgeMs = 10;
+	uint8_t direction = 0;				//!< REG_GPIO_CONTROL shadow, bit set = output
+	uint8_t pwm[8];						//!< REG_PORT_PWM_RATIO shadow for PORT0 - PORT7
+	uint8_t dirtyPwm = 0;				//!< Ports whose PWM ratio needs to be written
+	bool dirtyDirection = false;		//!< direction needs to be written
+	uint8_t inputs = 0;					//!< Input snapshot
+	bool inputsValid = false;
+	unsigned long inputsTime = 0;		//!< millis() when inputs was read
+};
+
+#endif /* MAX7360_ENABLE_GPIO */
+
+#endif /* __MAX7360GPIOEXPANDER_H */
@@ -0,0 +1,147 @@
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+
+#include "MAX7360HealthMonitor.h"
+#include "MAX7360GpioExpander.h"
+
+MAX7360HealthMonitor::MAX7360HealthMonitor(MAX7360 &chip) : chip(chip) {
+
+}
+
+MAX7360HealthMonitor::~MAX7360HealthMonitor() {
+
+}
+
+bool MAX7360HealthMonitor::captureConfiguration() {
+	haveConfig = chip.snapshot(config);
+	if (!haveConfig) {
+		return false;
+	}
+	lastCheck = millis();
+
+	if (config.getRegister(canaryReg) == getPowerOnDefault(canaryReg)) {
+		Log.warn("MAX7360 canary register 0x%02x is at its power-on default, resets cannot be detected", canaryReg);
+		return false;
+	}
+	return true;
+}
+
+void MAX7360HealthMonitor::loop() {
+	if (haveConfig && millis() - lastCheck >= checkPeriodMs) {
+		lastCheck = millis();
+		check();
+	}
+}
+
+bool MAX7360HealthMonitor::check() {
+	if (!haveConfig) {
+		return true;
+	}
+	checkCount++;
+
+	// Reading clears the flag
+	uint8_t timeoutFlag;
+	if (chip.readRegisters(MAX7360::REG_I2C_TIMEOUT_FLAG, &timeoutFlag, 1) && (timeoutFlag & MAX7360::REG_I2C_TIMEOUT_FLAG_MASK)) {
+		timeoutCount++;
+	}
+
+	// Get the expected value before reading, since the read updates the cache. If the canary was
+	// changed through the MAX7360 object since the last check, the cache has the new value.
+	uint8_t expected;
+	if (!chip.getCachedRegister(canaryReg, expected)) {
+		expected = config.getRegister(canaryReg);
+	}
+
+	uint8_t canary;
+	if (!chip.readRegisters(canaryReg, &canary, 1)) {
+		setFailed("not responding");
+		return false;
+	}
+	if (canary == expected) {
+		updateConfigFromCache();
+		status = MAX7360HealthStatus::OK;
+		return true;
+	}
+
+	// Chip has reset. The cache may hold values the chip no longer has.
+	unsigned long startUs = micros();
+
+	chip.invalidateCache();
+	if (!chip.restore(config)) {
+		setFailed("restore failed");
+		return false;
+	}
+	if (!chip.readRegisters(canaryReg, &canary, 1) || canary != config.getRegister(canaryReg)) {
+		setFailed("restore did not take effect");
+		return false;
+	}
+#if MAX7360_ENABLE_GPIO
+	if (gpioExpander) {
+		gpioExpander->reload();
+	}
+#endif
+	if (recoveryHandler) {
+		recoveryHandler(chip, recoveryContext);
+	}
+
+	lastRecoveryUs = (uint32_t)(micros() - startUs);
+	if (lastRecoveryUs > maxRecoveryUs) {
+		maxRecoveryUs = lastRecoveryUs;
+	}
+	lastRecoveryMillis = millis();
+	recoveryCount++;
+	status = MAX7360HealthStatus::RECOVERED;
+
+	Log.info("MAX7360 reset detected, configuration restored in %lu us", (unsigned long) lastRecoveryUs);
+
+	return false;
+}
+
+void MAX7360HealthMonitor::updateConfigFromCache() {
+	for(uint8_t reg = MAX7360Snapshot::LOW_FIRST; reg < MAX7360Snapshot::LOW_FIRST + MAX7360Snapshot::LOW_COUNT; reg++) {
+		uint8_t value;
+		if (chip.getCachedRegister(reg, value)) {
+			config.setRegister(reg, value);
+		}
+	}
+	for(uint8_t reg = MAX7360Snapshot::GPIO_FIRST; reg < MAX7360Snapshot::GPIO_FIRST + MAX7360Snapshot::GPIO_COUNT; reg++) {
+		uint8_t value;
+		if (reg >= MAX7360::REG_I2C_TIMEOUT_FLAG && reg <= MAX7360::REG_GPIO_ROTARY_SWITCH_COUNT) {
+			// Read-only, not restored
+			continue;
+		}
+		if (chip.getCachedRegister(reg, value)) {
+			config.setRegister(reg, value);
+		}
+	}
+}
+
+void MAX7360HealthMonitor::setFailed(const char *reason) {
+	failureCount++;
+	if (status != MAX7360HealthStatus::FAILED) {
+		// Only log the first failure so a disconnected chip doesn't fill the log
+		Log.warn("MAX7360 health check failed: %s", reason);
+	}
+	status = MAX7360HealthStatus::FAILED;
+}
+
+// [static]
+uint8_t MAX7360HealthMonitor::getPowerOnDefault(uint8_t reg) {
+	switch(reg) {
+	case MAX7360::REG_CONFIG:
+		return 0b00001010;
+
+	case MAX7360::REG_DEBOUNCE:
+		return 0xff;
+
+	case MAX7360::REG_GPO_CONTROL:
+		return 0b11111110;
+
+	case MAX7360::REG_AUTO_SLEEP:
+		return 0b00000111;
+
+	default:
+		// REG_KEY_SWITCH_INTERRUPT, REG_AUTO_REPEAT, and the GPIO registers 0x40 - 0x5f
+		return 0x00;
+	}
+}
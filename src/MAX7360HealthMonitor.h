@@ -0,0 +1,174 @@
+#ifndef __MAX7360HEALTHMONITOR_H
+#define __MAX7360HEALTHMONITOR_H
+
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+
+#include "MAX7360-RK.h"
+
+class MAX7360GpioExpander; // Forward declaration
+
+/**
+ * @brief Handler called to reconfigure the chip after it was detected to have reset
+ *
+ * @param chip The MAX7360 object
+ *
+ * @param context The context pointer passed to withRecoveryHandler()
+ */
+typedef void (*MAX7360RecoveryHandler)(MAX7360 &chip, void *context);
+
+/**
+ * @brief Result of the last MAX7360HealthMonitor check
+ */
+enum class MAX7360HealthStatus : uint8_t {
+	OK,					//!< Canary register matched the saved configuration (or not checked yet)
+	RECOVERED,			//!< Chip had reset and the saved configuration was restored and verified
+	FAILED				//!< Chip did not respond, or the restore could not be written or verified
+};
+
+/**
+ * @brief Detects when the MAX7360 has reset itself and restores the configuration
+ *
+ * If the chip loses power briefly (ESD, connector glitch) it returns to power-on defaults
+ * without telling anyone. The default GPO setting takes over COL2 - COL7, so the keypad
+ * stops working.
+ *
+ * After you've configured the chip, call begin() to save the configuration. Then every check
+ * period, loop() reads one canary register (default: REG_DEBOUNCE, which also holds the GPO
+ * enable bits) and compares it to the saved value. If it's different, the chip has been reset
+ * and the saved configuration is restored using MAX7360::restore(). It also reads the I2C
+ * timeout flag register and counts timeouts.
+ *
+ * A recovery only counts if restore() succeeded and the canary reads back correctly afterwards.
+ * If the chip doesn't respond or the restore fails, the check is counted as a failure instead,
+ * the recovery handler is not called, and the next check tries again.
+ *
+ * The canary must be set to something other than its power-on default (0xff for REG_DEBOUNCE),
+ * otherwise a reset can't be detected.
+ *
+ * While the chip is healthy, each check also updates the saved configuration from the
+ * MAX7360 register cache (see MAX7360::getCachedRegister()), which has the last value read or
+ * written for each register. Configuration changes, GPO outputs, and PWM ratios set through the
+ * MAX7360 object after begin() are restored too, as of the last good check. If you change
+ * registers some other way, call captureConfiguration() again.
+ *
+ * Before restoring, the register cache is invalidated, so the MAX7360 GPO shadow and cache
+ * only hold values that were written to the chip. If you use MAX7360GpioExpander, pass it to
+ * withGpioExpander() so its shadow is reloaded too.
+ */
+class MAX7360HealthMonitor {
+public:
+	/**
+	 * @brief Construct a health monitor
+	 *
+	 * @param chip The MAX7360 object
+	 */
+	MAX7360HealthMonitor(MAX7360 &chip);
+	virtual ~MAX7360HealthMonitor();
+
+	/**
+	 * @brief How often to check the chip (default: 1000 ms). Each check is two single-byte reads.
+	 */
+	MAX7360HealthMonitor &withCheckPeriodMs(unsigned long ms) { checkPeriodMs = ms; return *this; };
+
+	/**
+	 * @brief Register to compare against the saved configuration (default: REG_DEBOUNCE)
+	 *
+	 * Must be a register in MAX7360Snapshot that doesn't change on its own.
+	 */
+	MAX7360HealthMonitor &withCanaryRegister(uint8_t reg) { canaryReg = reg; return *this; };
+
+#if MAX7360_ENABLE_GPIO
+	/**
+	 * @brief GPIO expander to reload (MAX7360GpioExpander::reload()) after the configuration is restored
+	 */
+	MAX7360HealthMonitor &withGpioExpander(MAX7360GpioExpander *gpioExpander) { this->gpioExpander = gpioExpander; return *this; };
+#endif
+
+	/**
+	 * @brief Function to call after the saved configuration is restored
+	 *
+	 * Use this for things that aren't in the registers, like resetting your own key state.
+	 */
+	MAX7360HealthMonitor &withRecoveryHandler(MAX7360RecoveryHandler handler, void *context = 0) { recoveryHandler = handler; recoveryContext = context; return *this; };
+
+	/**
+	 * @brief Save the configuration and start monitoring. Call from setup() after configuring the chip.
+	 *
+	 * @return false if the configuration could not be read or the canary register is at its power-on default
+	 */
+	bool begin() { return captureConfiguration(); };
+
+	/**
+	 * @brief Save the current configuration as the one to restore
+	 *
+	 * Reads all of the registers from the chip. Call it again if you change registers without
+	 * going through the MAX7360 object.
+	 */
+	bool captureConfiguration();
+
+	/**
+	 * @brief Call from loop()
+	 */
+	void loop();
+
+	/**
+	 * @brief Check the chip now
+	 *
+	 * @return true if the chip was OK, false if a reset was detected (recovered or not) or the
+	 * chip did not respond. Use getStatus() to tell these apart.
+	 */
+	bool check();
+
+	/**
+	 * @brief Result of the last check
+	 */
+	MAX7360HealthStatus getStatus() const { return status; };
+
+	uint32_t getCheckCount() const { return checkCount; };				//!< Number of checks done
+	uint32_t getRecoveryCount() const { return recoveryCount; };		//!< Number of resets detected and recovered
+	uint32_t getTimeoutCount() const { return timeoutCount; };			//!< Number of times the I2C timeout flag was set
+	uint32_t getFailureCount() const { return failureCount; };			//!< Number of checks where the chip did not respond or could not be restored
+	uint32_t getLastRecoveryUs() const { return lastRecoveryUs; };		//!< Time the last recovery took in microseconds
+	uint32_t getMaxRecoveryUs() const { return maxRecoveryUs; };		//!< Longest recovery in microseconds
+	unsigned long getLastRecoveryMillis() const { return lastRecoveryMillis; };	//!< millis() value at the last recovery, 0 if none
+
+	/**
+	 * @brief Power-on default of a register in MAX7360Snapshot
+	 */
+	static uint8_t getPowerOnDefault(uint8_t reg);
+
+protected:
+	/**
+	 * @brief Count a failed check and log it if the previous check didn't fail
+	 */
+	void setFailed(const char *reason);
+
+	/**
+	 * @brief Update the saved configuration from the MAX7360 register cache
+	 */
+	void updateConfigFromCache();
+
+	MAX7360 &chip;
+	MAX7360Snapshot config;
+	bool haveConfig = false;
+	uint8_t canaryReg = MAX7360::REG_DEBOUNCE;
+	unsigned long checkPeriodMs = 1000;
+	unsigned long lastCheck = 0;
+	MAX7360RecoveryHandler recoveryHandler = 0;
+	void *recoveryContext = 0;
+#if MAX7360_ENABLE_GPIO
+	MAX7360GpioExpander *gpioExpander = 0;
+#endif
+
+	uint32_t checkCount = 0;
+	uint32_t recoveryCount = 0;
+	uint32_t timeoutCount = 0;
+	uint32_t failureCount = 0;
+	MAX7360HealthStatus status = MAX7360HealthStatus::OK;
+	uint32_t lastRecoveryUs = 0;
+	uint32_t maxRecoveryUs = 0;
+	unsigned long lastRecoveryMillis = 0;
+};
+
+#endif /* __MAX7360HEALTHMONITOR_H */
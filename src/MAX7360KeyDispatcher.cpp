@@ -0,0 +1,110 @@
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+
+#include "MAX7360KeyDispatcher.h"
+
+#if MAX7360_ENABLE_KEYPAD
+
+MAX7360KeyDispatcher::MAX7360KeyDispatcher(MAX7360KeyMappingBase *keyMapping) : keyMapping(keyMapping) {
+	removeAll();
+}
+
+MAX7360KeyDispatcher::~MAX7360KeyDispatcher() {
+
+}
+
+bool MAX7360KeyDispatcher::onRawKey(uint8_t rawKey, MAX7360KeyHandler pressHandler, MAX7360KeyHandler releaseHandler, MAX7360KeyHandler repeatHandler, void *context) {
+	if (rawKey >= NUM_KEYS) {
+		return false;
+	}
+	Entry &entry = table[rawKey];
+	entry.pressHandler = pressHandler;
+	entry.releaseHandler = releaseHandler;
+	entry.repeatHandler = repeatHandler;
+	entry.context = context;
+
+	return true;
+}
+
+bool MAX7360KeyDispatcher::onMappedKey(char c, MAX7360KeyHandler pressHandler, MAX7360KeyHandler releaseHandler, MAX7360KeyHandler repeatHandler, void *context) {
+	if (!keyMapping || c == 0) {
+		return false;
+	}
+	return onRawKey(keyMapping->readableToRaw(c), pressHandler, releaseHandler, repeatHandler, context);
+}
+
+void MAX7360KeyDispatcher::onAnyKey(MAX7360KeyHandler pressHandler, MAX7360KeyHandler releaseHandler, MAX7360KeyHandler repeatHandler, void *context) {
+	anyKey.pressHandler = pressHandler;
+	anyKey.releaseHandler = releaseHandler;
+	anyKey.repeatHandler = repeatHandler;
+	anyKey.context = context;
+}
+
+void MAX7360KeyDispatcher::removeRawKey(uint8_t rawKey) {
+	onRawKey(rawKey, 0, 0, 0, 0);
+}
+
+void MAX7360KeyDispatcher::removeAll() {
+	memset(table, 0, sizeof(table));
+	memset(&anyKey, 0, sizeof(anyKey));
+	lastPressedKey = MAX7360Key::FIFO_KEY_NONE;
+}
+
+bool MAX7360KeyDispatcher::dispatch(const MAX7360Key &key) {
+	if (key.isKeyRepeat()) {
+		// Repeat codes don't contain the key, use the last key pressed
+		if (lastPressedKey >= NUM_KEYS) {
+			return false;
+		}
+		return callHandler(table[lastPressedKey], &Entry::repeatHandler, key);
+	}
+
+	uint8_t rawKey = key.getRawKey();
+	if (rawKey >= NUM_KEYS) {
+		// Empty or overflow
+		return false;
+	}
+
+	if (key.isReleased()) {
+		if (rawKey == lastPressedKey) {
+			lastPressedKey = MAX7360Key::FIFO_KEY_NONE;
+		}
+		return callHandler(table[rawKey], &Entry::releaseHandler, key);
+	}
+	else {
+		lastPressedKey = rawKey;
+		return callHandler(table[rawKey], &Entry::pressHandler, key);
+	}
+}
+
+size_t MAX7360KeyDispatcher::dispatchAll(MAX7360 &chip) {
+	size_t count = 0;
+
+	while(true) {
+		MAX7360Key key = chip.readKeyFIFO();
+		if (key.isEmpty()) {
+			break;
+		}
+		dispatch(key);
+		count++;
+
+		if (!key.hasMore()) {
+			break;
+		}
+	}
+	return count;
+}
+
+bool MAX7360KeyDispatcher::callHandler(const Entry &entry, MAX7360KeyHandler Entry::*which, const MAX7360Key &key) {
+	if (entry.*which) {
+		(entry.*which)(key, entry.context);
+		return true;
+	}
+	if (anyKey.*which) {
+		(anyKey.*which)(key, anyKey.context);
+		return true;
+	}
+	return false;
+}
+
+#endif /* MAX7360_ENABLE_KEYPAD */
@@ -0,0 +1,126 @@
+#ifndef __MAX7360KEYDISPATCHER_H
+#define __MAX7360KEYDISPATCHER_H
+
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+
+#include "MAX7360-RK.h"
+
+#if MAX7360_ENABLE_KEYPAD
+
+/**
+ * @brief Handler function for key events
+ *
+ * @param key The key event from the FIFO
+ *
+ * @param context The context pointer passed when the handler was registered
+ */
+typedef void (*MAX7360KeyHandler)(const MAX7360Key &key, void *context);
+
+/**
+ * @brief Dispatches key events to handlers registered per key
+ *
+ * Instead of writing a switch statement on getMappedKey(), register a handler for each key
+ * you're interested in. The handlers are stored in a fixed 64-entry table indexed by raw key
+ * (KEY0 - KEY63), so dispatching is a single table lookup regardless of how many keys are
+ * registered, and no memory is allocated.
+ *
+ * Handlers registered by mapped character are converted to a raw key when registered, using
+ * the key mapping object, so the mapping must be set before registering.
+ *
+ * The auto-repeat FIFO codes don't include the key, so repeats are dispatched to the repeat
+ * handler of the last key pressed.
+ */
+class MAX7360KeyDispatcher {
+public:
+	/**
+	 * @brief Construct a dispatcher
+	 *
+	 * @param keyMapping The key mapping object, used to register handlers by mapped character. Can be 0
+	 * if you only register by raw key.
+	 */
+	MAX7360KeyDispatcher(MAX7360KeyMappingBase *keyMapping = 0);
+	virtual ~MAX7360KeyDispatcher();
+
+	/**
+	 * @brief Register handlers by raw key (0 - 63)
+	 *
+	 * @param rawKey The raw key number 0 - 63
+	 *
+	 * @param pressHandler Called when the key is pressed. Can be 0.
+	 *
+	 * @param releaseHandler Called when the key is released (only if key release events are enabled). Can be 0.
+	 *
+	 * @param repeatHandler Called on auto-repeat while the key is held (only if auto-repeat is enabled). Can be 0.
+	 *
+	 * @param context Passed to the handlers
+	 *
+	 * @return true if registered, false if rawKey is out of range.
+	 */
+	bool onRawKey(uint8_t rawKey, MAX7360KeyHandler pressHandler, MAX7360KeyHandler releaseHandler = 0, MAX7360KeyHandler repeatHandler = 0, void *context = 0);
+
+	/**
+	 * @brief Register handlers by mapped character, such as '5' or '#'
+	 *
+	 * @return true if registered, false if there is no key mapping or the character is not in it.
+	 */
+	bool onMappedKey(char c, MAX7360KeyHandler pressHandler, MAX7360KeyHandler releaseHandler = 0, MAX7360KeyHandler repeatHandler = 0, void *context = 0);
+
+	/**
+	 * @brief Register handlers called for keys that don't have their own handler
+	 */
+	void onAnyKey(MAX7360KeyHandler pressHandler, MAX7360KeyHandler releaseHandler = 0, MAX7360KeyHandler repeatHandler = 0, void *context = 0);
+
+	/**
+	 * @brief Remove the handlers for a raw key
+	 */
+	void removeRawKey(uint8_t rawKey);
+
+	/**
+	 * @brief Remove all handlers
+	 */
+	void removeAll();
+
+	/**
+	 * @brief Dispatch a key read from the FIFO
+	 *
+	 * @return true if a handler was called, false if the key was empty or had no handler.
+	 */
+	bool dispatch(const MAX7360Key &key);
+
+	/**
+	 * @brief Read and dispatch all keys in the FIFO
+	 *
+	 * @param chip The MAX7360 to read from
+	 *
+	 * @return The number of FIFO entries dispatched
+	 */
+	size_t dispatchAll(MAX7360 &chip);
+
+	static const size_t NUM_KEYS = 64;		//!< Number of entries in the table (KEY0 - KEY63)
+
+protected:
+	/**
+	 * @brief Handlers for one key
+	 */
+	struct Entry {
+		MAX7360KeyHandler pressHandler;
+		MAX7360KeyHandler releaseHandler;
+		MAX7360KeyHandler repeatHandler;
+		void *context;
+	};
+
+	/**
+	 * @brief Call the handler in entry, falling back to anyKey if the entry has no handler of that kind
+	 */
+	bool callHandler(const Entry &entry, MAX7360KeyHandler Entry::*which, const MAX7360Key &key);
+
+	MAX7360KeyMappingBase *keyMapping;
+	Entry table[NUM_KEYS];
+	Entry anyKey;
+	uint8_t lastPressedKey = MAX7360Key::FIFO_KEY_NONE;
+};
+
+#endif /* MAX7360_ENABLE_KEYPAD */
+
+#endif /* __MAX7360KEYDISPATCHER_H */
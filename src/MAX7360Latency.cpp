@@ -0,0 +1,171 @@
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+
+#include "MAX7360Latency.h"
+
+#if MAX7360_ENABLE_INSTRUMENTATION
+
+MAX7360LatencyMonitor *MAX7360LatencyMonitor::instance = 0;
+
+MAX7360LatencyHistogram::MAX7360LatencyHistogram() {
+	reset();
+}
+
+void MAX7360LatencyHistogram::record(uint32_t us) {
+	bins[binIndex(us)]++;
+	if (count == 0 || us < minUs) {
+		minUs = us;
+	}
+	if (us > maxUs) {
+		maxUs = us;
+	}
+	sumUs += us;
+	count++;
+}
+
+void MAX7360LatencyHistogram::reset() {
+	memset(bins, 0, sizeof(bins));
+	count = minUs = maxUs = 0;
+	sumUs = 0;
+}
+
+uint32_t MAX7360LatencyHistogram::getPercentile(uint8_t pct) const {
+	if (count == 0) {
+		return 0;
+	}
+	// Number of samples that must be at or below the result, rounded up
+	uint64_t target = ((uint64_t)count * pct + 99) / 100;
+	if (target == 0) {
+		target = 1;
+	}
+
+	uint64_t cumulative = 0;
+	for(size_t ii = 0; ii < NUM_BINS; ii++) {
+		cumulative += bins[ii];
+		if (cumulative >= target) {
+			uint32_t upper = binUpperBound(ii);
+			return (upper < maxUs) ? upper : maxUs;
+		}
+	}
+	return maxUs;
+}
+
+MAX7360LatencyStats MAX7360LatencyHistogram::getStats() const {
+	MAX7360LatencyStats stats;
+
+	stats.count = count;
+	stats.minUs = minUs;
+	stats.meanUs = (count > 0) ? (uint32_t)(sumUs / count) : 0;
+	stats.p99Us = getPercentile(99);
+	stats.maxUs = maxUs;
+
+	return stats;
+}
+
+size_t MAX7360LatencyHistogram::binIndex(uint32_t us) {
+	if (us < 4) {
+		return us;
+	}
+	uint32_t exp = 31 - __builtin_clz(us);
+	uint32_t sub = (us >> (exp - 2)) & 3;
+	size_t index = 4 + (exp - 2) * 4 + sub;
+
+	return (index < NUM_BINS) ? index : (NUM_BINS - 1);
+}
+
+uint32_t MAX7360LatencyHistogram::binUpperBound(size_t index) {
+	if (index < 4) {
+		return (uint32_t) index;
+	}
+	if (index >= NUM_BINS - 1) {
+		return 0xffffffff;
+	}
+	uint32_t exp = (uint32_t)((index - 4) / 4) + 2;
+	uint32_t sub = (uint32_t)((index - 4) % 4);
+	uint32_t lower = (4 + sub) << (exp - 2);
+
+	return lower + (1 << (exp - 2)) - 1;
+}
+
+
+MAX7360LatencyMonitor::MAX7360LatencyMonitor() {
+
+}
+
+MAX7360LatencyMonitor::~MAX7360LatencyMonitor() {
+	end();
+}
+
+bool MAX7360LatencyMonitor::begin(MAX7360 &chip, pin_t intkPin) {
+	this->chip = &chip;
+	this->intkPin = intkPin;
+
+	debounceMs = chip.getDebounceTimeMs();
+
+	instance = this;
+	chip.withLatencyMonitor(this);
+
+	pinMode(intkPin, INPUT_PULLUP);
+	return attachInterrupt(intkPin, intkISR, FALLING);
+}
+
+void MAX7360LatencyMonitor::end() {
+	if (instance == this) {
+		detachInterrupt(intkPin);
+		instance = 0;
+	}
+	if (chip) {
+		chip->withLatencyMonitor(0);
+		chip = 0;
+	}
+}
+
+void MAX7360LatencyMonitor::markFifoRead(unsigned long startUs, unsigned long endUs) {
+	if (intPending && !readPending) {
+		readTimeUs = endUs;
+		readPending = true;
+		wait.record((uint32_t)(startUs - intTimeUs));
+		bus.record((uint32_t)(endUs - startUs));
+	}
+}
+
+void MAX7360LatencyMonitor::markConsumed() {
+	if (readPending) {
+		unsigned long now = micros();
+		app.record((uint32_t)(now - readTimeUs));
+		total.record((uint32_t)(now - intTimeUs));
+		readPending = false;
+		intPending = false;
+	}
+}
+
+void MAX7360LatencyMonitor::reset() {
+	wait.reset();
+	bus.reset();
+	app.reset();
+	total.reset();
+}
+
+void MAX7360LatencyMonitor::logStats() const {
+	const MAX7360LatencyHistogram *histograms[4] = { &wait, &bus, &app, &total };
+	const char *names[4] = { "wait", "bus", "app", "total" };
+
+	Log.info("debounce=%u ms (before /INTK, not included below)", debounceMs);
+	for(size_t ii = 0; ii < 4; ii++) {
+		MAX7360LatencyStats stats = histograms[ii]->getStats();
+		Log.info("%s count=%lu min=%lu mean=%lu p99=%lu max=%lu us", names[ii],
+			(unsigned long)stats.count, (unsigned long)stats.minUs, (unsigned long)stats.meanUs,
+			(unsigned long)stats.p99Us, (unsigned long)stats.maxUs);
+	}
+}
+
+// [static]
+void MAX7360LatencyMonitor::intkISR() {
+	MAX7360LatencyMonitor *monitor = instance;
+	if (monitor && !monitor->intPending) {
+		monitor->intTimeUs = micros();
+		monitor->intPending = true;
+	}
+}
+
+#endif /* MAX7360_ENABLE_INSTRUMENTATION */
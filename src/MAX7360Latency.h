@@ -0,0 +1,185 @@
+#ifndef __MAX7360LATENCY_H
+#define __MAX7360LATENCY_H
+
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+
+#include "MAX7360-RK.h"
+
+#if MAX7360_ENABLE_INSTRUMENTATION
+
+/**
+ * @brief Summary statistics from a MAX7360LatencyHistogram, all in microseconds
+ */
+struct MAX7360LatencyStats {
+	uint32_t count;			//!< Number of samples
+	uint32_t minUs;			//!< Smallest sample
+	uint32_t meanUs;		//!< Mean of all samples
+	uint32_t p99Us;			//!< 99th percentile (upper bound of the histogram bin)
+	uint32_t maxUs;			//!< Largest sample
+};
+
+/**
+ * @brief Fixed-size latency histogram
+ *
+ * Bins are logarithmic with 4 bins per power of two, so the error of a percentile is at most
+ * 25% of the value, from 1 us up to about 16 seconds. Larger values go in the last bin.
+ * min, max, and mean are exact.
+ */
+class MAX7360LatencyHistogram {
+public:
+	MAX7360LatencyHistogram();
+
+	/**
+	 * @brief Add a sample
+	 */
+	void record(uint32_t us);
+
+	/**
+	 * @brief Remove all samples
+	 */
+	void reset();
+
+	/**
+	 * @brief Get the value below which pct percent of the samples fall (upper bound of the bin)
+	 *
+	 * @param pct Percentile 0 - 100
+	 */
+	uint32_t getPercentile(uint8_t pct) const;
+
+	/**
+	 * @brief Get the summary statistics
+	 */
+	MAX7360LatencyStats getStats() const;
+
+	uint32_t getCount() const { return count; };			//!< Number of samples
+
+	/**
+	 * @brief Bin index for a value
+	 */
+	static size_t binIndex(uint32_t us);
+
+	/**
+	 * @brief Largest value in a bin
+	 */
+	static uint32_t binUpperBound(size_t index);
+
+	static const size_t NUM_BINS = 92;		//!< 0 - 3 us, then 4 bins per power of two up to 2^24 us
+
+protected:
+	uint32_t bins[NUM_BINS];
+	uint32_t count;
+	uint32_t minUs;
+	uint32_t maxUs;
+	uint64_t sumUs;
+};
+
+/**
+ * @brief Measures key latency from /INTK to the application
+ *
+ * Four times are captured for each key event:
+ *
+ * - The /INTK falling edge, timestamped in an interrupt service routine
+ * - The start and end of the FIFO read transaction, marked automatically by MAX7360::readKeyFIFO()
+ * - Application consumption, when you call markConsumed()
+ *
+ * These are accumulated into four histograms: wait (/INTK to the start of the FIFO read, mostly
+ * the time until your code polls the FIFO), bus (the FIFO read itself: bus lock and I2C transfer,
+ * including any repeat read-ahead), app (end of the FIFO read to consumed), and total (/INTK to
+ * consumed). The chip's debounce time (getDebounceMs()) is before /INTK is asserted, so it's
+ * not included in the measured times; add it to get the time from the key press.
+ *
+ * /INTK must be configured to assert on key events (MAX7360::setKeySwitchInterrupt). Only one
+ * latency monitor can be active at a time because it uses a static interrupt handler.
+ */
+class MAX7360LatencyMonitor {
+public:
+	MAX7360LatencyMonitor();
+	virtual ~MAX7360LatencyMonitor();
+
+	/**
+	 * @brief Start monitoring. Call from setup() after MAX7360::begin().
+	 *
+	 * @param chip The MAX7360 object. FIFO reads through it are timestamped.
+	 *
+	 * @param intkPin The MCU pin connected to /INTK
+	 */
+	bool begin(MAX7360 &chip, pin_t intkPin);
+
+	/**
+	 * @brief Stop monitoring and detach the interrupt
+	 */
+	void end();
+
+	/**
+	 * @brief Called by MAX7360::readKeyFIFO() after a non-empty FIFO read
+	 *
+	 * @param startUs micros() before the read started
+	 *
+	 * @param endUs micros() after the read completed
+	 */
+	void markFifoRead(unsigned long startUs, unsigned long endUs);
+
+	/**
+	 * @brief Call when your application has handled the key
+	 */
+	void markConsumed();
+
+	/**
+	 * @brief Clear all histograms
+	 */
+	void reset();
+
+	/**
+	 * @brief Chip debounce time in milliseconds, read in begin()
+	 */
+	uint8_t getDebounceMs() const { return debounceMs; };
+
+	/**
+	 * @brief /INTK to the start of the FIFO read
+	 */
+	const MAX7360LatencyHistogram &getWaitHistogram() const { return wait; };
+
+	/**
+	 * @brief Duration of the FIFO read transaction
+	 */
+	const MAX7360LatencyHistogram &getBusHistogram() const { return bus; };
+
+	/**
+	 * @brief End of the FIFO read to markConsumed()
+	 */
+	const MAX7360LatencyHistogram &getAppHistogram() const { return app; };
+
+	/**
+	 * @brief /INTK to markConsumed()
+	 */
+	const MAX7360LatencyHistogram &getTotalHistogram() const { return total; };
+
+	/**
+	 * @brief Log the statistics using Log.info
+	 */
+	void logStats() const;
+
+protected:
+	static void intkISR();
+
+	static MAX7360LatencyMonitor *instance;
+
+	MAX7360 *chip = 0;
+	pin_t intkPin = PIN_INVALID;
+	uint8_t debounceMs = 0;
+
+	volatile bool intPending = false;
+	volatile unsigned long intTimeUs = 0;
+	bool readPending = false;
+	unsigned long readTimeUs = 0;		//!< End of the FIFO read
+
+	MAX7360LatencyHistogram wait;
+	MAX7360LatencyHistogram bus;
+	MAX7360LatencyHistogram app;
+	MAX7360LatencyHistogram total;
+};
+
+#endif /* MAX7360_ENABLE_INSTRUMENTATION */
+
+#endif /* __MAX7360LATENCY_H */
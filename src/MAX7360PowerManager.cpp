@@ -0,0 +1,110 @@
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+
+#include "MAX7360PowerManager.h"
+
+MAX7360PowerManager::MAX7360PowerManager(MAX7360 &chip, pin_t intkPin) : chip(chip), intkPin(intkPin) {
+
+}
+
+MAX7360PowerManager::~MAX7360PowerManager() {
+
+}
+
+bool MAX7360PowerManager::begin() {
+	if (intkPin != PIN_INVALID) {
+		// /INTK is open-drain, active low
+		pinMode(intkPin, INPUT_PULLUP);
+
+		if (chip.readRegister(MAX7360::REG_KEY_SWITCH_INTERRUPT) == 0x00) {
+			// /INTK is disabled (power-on default), assert it on key events
+			chip.setKeySwitchInterrupt(0x01);
+		}
+	}
+
+	// Wake the chip from auto-sleep on key press
+	chip.setConfigurationAutoWakeUp(true);
+
+	idleLevel = 0xff;
+	lastAutoSleep = 0xff;
+	activity();
+
+	return true;
+}
+
+bool MAX7360PowerManager::loop() {
+	unsigned long now = millis();
+
+	if (intkPin != PIN_INVALID && digitalRead(intkPin) == LOW) {
+		// Chip has events, poll now regardless of the interval
+		activity();
+		lastPoll = now;
+		return true;
+	}
+
+	unsigned long idleMs = now - lastActivity;
+
+	unsigned long level = (idleStepMs > 0) ? (idleMs / idleStepMs) : 0;
+	if (level > MAX_IDLE_LEVEL) {
+		level = MAX_IDLE_LEVEL;
+	}
+	if (level != idleLevel) {
+		setIdleLevel((uint8_t)level);
+	}
+
+	if (sleepAfterMs != 0 && intkPin != PIN_INVALID && idleMs >= sleepAfterMs) {
+		sleep();
+		activity();
+		lastPoll = millis();
+		return true;
+	}
+
+	if (now - lastPoll >= pollMs) {
+		lastPoll = now;
+		return true;
+	}
+	return false;
+}
+
+void MAX7360PowerManager::activity() {
+	lastActivity = millis();
+	if (idleLevel != 0) {
+		setIdleLevel(0);
+	}
+}
+
+void MAX7360PowerManager::setIdleLevel(uint8_t level) {
+	idleLevel = level;
+
+	pollMs = minPollMs << level;
+	if (pollMs > maxPollMs || pollMs < minPollMs) {
+		pollMs = maxPollMs;
+	}
+
+	// Level 0 = 8192 ms (REG_AUTO_SLEEP_8192_MS) down to level 5 and above = 256 ms (REG_AUTO_SLEEP_256_MS)
+	uint8_t autoSleep = MAX7360::REG_AUTO_SLEEP_8192_MS + level;
+	if (autoSleep > MAX7360::REG_AUTO_SLEEP_256_MS) {
+		autoSleep = MAX7360::REG_AUTO_SLEEP_256_MS;
+	}
+	if (autoSleep != lastAutoSleep) {
+		lastAutoSleep = autoSleep;
+		chip.setAutoSleep(autoSleep);
+	}
+}
+
+void MAX7360PowerManager::sleep() {
+	if (digitalRead(intkPin) == LOW) {
+		// Event arrived while deciding to sleep
+		return;
+	}
+
+	SystemSleepConfiguration config;
+	config.mode(SystemSleepMode::STOP)
+		.gpio(intkPin, FALLING);
+	if (maxSleepMs != 0) {
+		config.duration(maxSleepMs);
+	}
+	System.sleep(config);
+
+	sleepCount++;
+}
@@ -0,0 +1,140 @@
+#ifndef __MAX7360POWERMANAGER_H
+#define __MAX7360POWERMANAGER_H
+
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+
+#include "MAX7360-RK.h"
+
+/**
+ * @brief Adjusts the host polling interval and chip auto-sleep based on keypad activity
+ *
+ * While keys are being pressed, loop() asks you to poll the chip every minimum poll interval.
+ * Each time another idle step passes with no activity, the poll interval doubles, up to the
+ * maximum poll interval. The chip auto-sleep timer (REG_AUTO_SLEEP) is shortened to match,
+ * from 8192 ms when active down to 256 ms when fully idle.
+ *
+ * If you pass in the MCU pin connected to /INTK, a low /INTK causes an immediate poll, and
+ * you can optionally put the MCU into STOP mode sleep after a period of inactivity with
+ * /INTK as the wake source.
+ *
+ * Typical use:
+ *
+ * ```
+ * void loop() {
+ *     if (powerManager.loop()) {
+ *         MAX7360Key key = keyDriver.readKeyFIFO();
+ *         if (!key.isEmpty()) {
+ *             powerManager.activity();
+ *             // Handle the key here
+ *         }
+ *     }
+ * }
+ * ```
+ */
+class MAX7360PowerManager {
+public:
+	/**
+	 * @brief Construct the power manager
+	 *
+	 * @param chip The MAX7360 object
+	 *
+	 * @param intkPin The MCU pin connected to /INTK, or PIN_INVALID if not connected. Required for STOP mode sleep.
+	 */
+	MAX7360PowerManager(MAX7360 &chip, pin_t intkPin = PIN_INVALID);
+	virtual ~MAX7360PowerManager();
+
+	/**
+	 * @brief Sets the poll interval range (default: 10 ms to 500 ms)
+	 *
+	 * @param minMs Poll interval when there is activity
+	 *
+	 * @param maxMs Longest poll interval when idle
+	 */
+	MAX7360PowerManager &withPollIntervalMs(unsigned long minMs, unsigned long maxMs) { minPollMs = minMs; maxPollMs = maxMs; return *this; };
+
+	/**
+	 * @brief Sets how long without activity before the poll interval doubles (default: 2000 ms)
+	 */
+	MAX7360PowerManager &withIdleStepMs(unsigned long ms) { idleStepMs = ms; return *this; };
+
+	/**
+	 * @brief Enables STOP mode sleep of the MCU after a period of inactivity (default: disabled)
+	 *
+	 * @param idleMs Milliseconds of inactivity before sleeping, or 0 to disable sleep.
+	 *
+	 * @param maxSleepMs Maximum time to sleep, or 0 to sleep until /INTK is asserted. Set this
+	 * if you also need to check GPIO or rotary inputs, which don't assert /INTK.
+	 *
+	 * The intkPin must be set in the constructor for sleep to be used.
+	 */
+	MAX7360PowerManager &withStopModeSleep(unsigned long idleMs, unsigned long maxSleepMs = 0) { sleepAfterMs = idleMs; this->maxSleepMs = maxSleepMs; return *this; };
+
+	/**
+	 * @brief Configure the chip. Call from setup() after MAX7360::begin().
+	 *
+	 * Enables auto wake-up, enables /INTK on key events if it's disabled, and sets the
+	 * auto-sleep time for the active state.
+	 */
+	bool begin();
+
+	/**
+	 * @brief Call from loop()
+	 *
+	 * @return true if you should poll the chip (read the FIFO, GPIO, etc.) now
+	 *
+	 * This may put the MCU to sleep if STOP mode sleep is enabled and the idle time has passed.
+	 * It always returns true after waking.
+	 */
+	bool loop();
+
+	/**
+	 * @brief Call when you get a key or other input event to go back to fast polling
+	 */
+	void activity();
+
+	/**
+	 * @brief Gets the current poll interval in milliseconds
+	 */
+	unsigned long getPollIntervalMs() const { return pollMs; };
+
+	/**
+	 * @brief Gets the idle level. 0 = active, each level doubles the poll interval.
+	 */
+	uint8_t getIdleLevel() const { return idleLevel; };
+
+	/**
+	 * @brief Gets the number of times the MCU was put to sleep
+	 */
+	uint32_t getSleepCount() const { return sleepCount; };
+
+	static const uint8_t MAX_IDLE_LEVEL = 10;	//!< Highest idle level (the poll interval is also limited by maxPollMs)
+
+protected:
+	/**
+	 * @brief Update the poll interval and chip auto-sleep for a new idle level
+	 */
+	void setIdleLevel(uint8_t level);
+
+	/**
+	 * @brief Put the MCU into STOP mode sleep until /INTK is asserted (or maxSleepMs)
+	 */
+	void sleep();
+
+	MAX7360 &chip;
+	pin_t intkPin;
+	unsigned long minPollMs = 10;
+	unsigned long maxPollMs = 500;
+	unsigned long idleStepMs = 2000;
+	unsigned long sleepAfterMs = 0;
+	unsigned long maxSleepMs = 0;
+
+	unsigned long pollMs = 10;
+	unsigned long lastActivity = 0;
+	unsigned long lastPoll = 0;
+	uint8_t idleLevel = 0xff;
+	uint8_t lastAutoSleep = 0xff;
+	uint32_t sleepCount = 0;
+};
+
+#endif /* __MAX7360POWERMANAGER_H */
@@ -0,0 +1,82 @@
+#ifndef __MAX7360RINGBUFFER_H
+#define __MAX7360RINGBUFFER_H
+
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+
+#include <stddef.h>
+
+/**
+ * @brief Fixed-size FIFO queue used by the event classes in this library
+ *
+ * @param T The element type. Must be copyable.
+ *
+ * @param SIZE The maximum number of elements
+ *
+ * No memory is allocated; storage is part of the object. This class is not thread or ISR safe
+ * on its own.
+ */
+template<class T, size_t SIZE>
+class MAX7360RingBuffer {
+public:
+	/**
+	 * @brief Add an element to the end of the queue
+	 *
+	 * @return true if added, false if the queue is full (the element is discarded and the drop counter incremented)
+	 */
+	bool push(const T &value) {
+		if (count >= SIZE) {
+			dropCount++;
+			return false;
+		}
+		buf[(readIndex + count) % SIZE] = value;
+		count++;
+		return true;
+	}
+
+	/**
+	 * @brief Remove the element at the front of the queue
+	 *
+	 * @return true if an element was copied to value, false if the queue is empty
+	 */
+	bool pop(T &value) {
+		if (count == 0) {
+			return false;
+		}
+		value = buf[readIndex];
+		readIndex = (readIndex + 1) % SIZE;
+		count--;
+		return true;
+	}
+
+	/**
+	 * @brief Get the element at the front of the queue without removing it, or 0 if empty
+	 */
+	T *front() { return (count > 0) ? &buf[readIndex] : 0; };
+
+	/**
+	 * @brief Get the most recently added element, or 0 if empty
+	 *
+	 * This is used to coalesce a new event into the previous one instead of adding another.
+	 */
+	T *back() { return (count > 0) ? &buf[(readIndex + count - 1) % SIZE] : 0; };
+
+	/**
+	 * @brief Remove all elements
+	 */
+	void clear() { readIndex = count = 0; };
+
+	size_t size() const { return count; };					//!< Number of elements in the queue
+	bool isEmpty() const { return count == 0; };			//!< Returns true if the queue is empty
+	bool isFull() const { return count >= SIZE; };			//!< Returns true if the queue is full
+	size_t capacity() const { return SIZE; };				//!< Maximum number of elements
+	size_t getDropCount() const { return dropCount; };		//!< Number of elements discarded because the queue was full
+
+protected:
+	T buf[SIZE];
+	size_t readIndex = 0;
+	size_t count = 0;
+	size_t dropCount = 0;
+};
+
+#endif /* __MAX7360RINGBUFFER_H */
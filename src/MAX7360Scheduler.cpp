@@ -0,0 +1,171 @@
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+
+#include "MAX7360Scheduler.h"
+
+MAX7360Scheduler::MAX7360Scheduler(MAX7360 &chip, pin_t intkPin) : chip(chip), intkPin(intkPin) {
+	memset(classes, 0, sizeof(classes));
+	classes[(size_t)MAX7360Priority::BEST_EFFORT].budgetUs = 1000;
+	classes[(size_t)MAX7360Priority::BACKGROUND].budgetUs = 500;
+}
+
+MAX7360Scheduler::~MAX7360Scheduler() {
+
+}
+
+void MAX7360Scheduler::begin() {
+	if (intkPin != PIN_INVALID) {
+		pinMode(intkPin, INPUT_PULLUP);
+	}
+}
+
+MAX7360Scheduler &MAX7360Scheduler::withBudgetUs(MAX7360Priority priority, uint32_t budgetUs) {
+	classes[(size_t)priority].budgetUs = budgetUs;
+	return *this;
+}
+
+bool MAX7360Scheduler::writeRegister(MAX7360Priority priority, uint8_t reg, uint8_t value) {
+	PriorityClass &pc = classes[(size_t)priority];
+
+	if (priority == MAX7360Priority::URGENT) {
+		unsigned long startUs = micros();
+		bool result = chip.writeRegister(reg, value);
+		account(pc, startUs, result);
+		return result;
+	}
+
+	if (priority == MAX7360Priority::BEST_EFFORT) {
+		// Replace an older queued write to the same register. Only output values are coalesced;
+		// BACKGROUND configuration writes are all sent in order, since an earlier write (like
+		// the GPIO reset bit) can matter even if the register is written again.
+		for(size_t ii = 0; ii < pc.count; ii++) {
+			if (pc.queue[ii].reg == reg) {
+				pc.queue[ii].value = value;
+				pc.stats.coalesced++;
+				return true;
+			}
+		}
+	}
+
+	if (pc.count >= QUEUE_SIZE) {
+		pc.stats.dropped++;
+		return false;
+	}
+
+	pc.queue[pc.count].reg = reg;
+	pc.queue[pc.count].value = value;
+	pc.count++;
+
+	pc.stats.queueDepth = (uint16_t) pc.count;
+	if (pc.stats.queueDepth > pc.stats.maxQueueDepth) {
+		pc.stats.maxQueueDepth = pc.stats.queueDepth;
+	}
+	return true;
+}
+
+uint8_t MAX7360Scheduler::readRegister(uint8_t reg) {
+	unsigned long startUs = micros();
+	uint8_t value = chip.readRegister(reg);
+	account(classes[(size_t)MAX7360Priority::URGENT], startUs);
+	return value;
+}
+
+MAX7360Key MAX7360Scheduler::readKeyFIFO() {
+	unsigned long startUs = micros();
+	MAX7360Key key = chip.readKeyFIFO();
+	account(classes[(size_t)MAX7360Priority::URGENT], startUs);
+	return key;
+}
+
+size_t MAX7360Scheduler::drainKeyFIFO(MAX7360Key *keys, size_t maxKeys) {
+	size_t count = 0;
+
+	while(count < maxKeys) {
+		MAX7360Key key = readKeyFIFO();
+		if (key.isEmpty()) {
+			break;
+		}
+		keys[count++] = key;
+		if (!key.hasMore()) {
+			break;
+		}
+	}
+	return count;
+}
+
+bool MAX7360Scheduler::isHighPriorityPending() const {
+	return (intkPin != PIN_INVALID && digitalRead(intkPin) == LOW);
+}
+
+void MAX7360Scheduler::loop() {
+	for(size_t ii = (size_t)MAX7360Priority::BEST_EFFORT; ii < NUM_CLASSES; ii++) {
+		if (!service(classes[ii], false)) {
+			// Stopped for high-priority work, leave the rest for the next loop
+			for(size_t jj = ii + 1; jj < NUM_CLASSES; jj++) {
+				if (classes[jj].count) {
+					classes[jj].stats.deferred++;
+				}
+			}
+			break;
+		}
+	}
+}
+
+void MAX7360Scheduler::flush() {
+	for(size_t ii = (size_t)MAX7360Priority::BEST_EFFORT; ii < NUM_CLASSES; ii++) {
+		service(classes[ii], true);
+	}
+}
+
+void MAX7360Scheduler::resetStats() {
+	for(size_t ii = 0; ii < NUM_CLASSES; ii++) {
+		memset(&classes[ii].stats, 0, sizeof(MAX7360SchedulerStats));
+		classes[ii].stats.queueDepth = classes[ii].stats.maxQueueDepth = (uint16_t) classes[ii].count;
+	}
+}
+
+bool MAX7360Scheduler::service(PriorityClass &pc, bool ignoreBudget) {
+	unsigned long serviceStartUs = micros();
+	size_t sent = 0;
+
+	while(sent < pc.count) {
+		if (!ignoreBudget) {
+			if (isHighPriorityPending()) {
+				pc.stats.deferred++;
+				break;
+			}
+			if (sent > 0 && micros() - serviceStartUs >= pc.budgetUs) {
+				pc.stats.deferred++;
+				break;
+			}
+		}
+
+		unsigned long startUs = micros();
+		bool result = chip.writeRegister(pc.queue[sent].reg, pc.queue[sent].value);
+		account(pc, startUs, result);
+		if (!result) {
+			// Leave the failed write at the front of the queue to retry on the next call
+			break;
+		}
+		sent++;
+	}
+
+	// Remove the sent writes from the front of the queue
+	if (sent > 0) {
+		memmove(&pc.queue[0], &pc.queue[sent], (pc.count - sent) * sizeof(QueuedWrite));
+		pc.count -= sent;
+		pc.stats.queueDepth = (uint16_t) pc.count;
+	}
+
+	return (pc.count == 0) || !isHighPriorityPending();
+}
+
+void MAX7360Scheduler::account(PriorityClass &pc, unsigned long startUs, bool success) {
+	if (success) {
+		pc.stats.transactions++;
+	}
+	else {
+		pc.stats.errors++;
+	}
+	pc.stats.busTimeUs += (uint32_t)(micros() - startUs);
+}
@@ -0,0 +1,179 @@
+#ifndef __MAX7360SCHEDULER_H
+#define __MAX7360SCHEDULER_H
+
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+
+#include "MAX7360-RK.h"
+
+/**
+ * @brief Priority class for I2C traffic through MAX7360Scheduler
+ */
+enum class MAX7360Priority : uint8_t {
+	URGENT = 0,			//!< Interrupt service and FIFO drain. Executed immediately.
+	BEST_EFFORT,		//!< LED and GPIO output. Queued, newer writes to the same register replace older ones.
+	BACKGROUND			//!< Configuration. Queued in order, executed after best-effort traffic.
+};
+
+/**
+ * @brief Per-priority-class statistics from MAX7360Scheduler
+ */
+struct MAX7360SchedulerStats {
+	uint16_t queueDepth;			//!< Writes currently queued
+	uint16_t maxQueueDepth;			//!< Highest queue depth seen
+	uint32_t transactions;			//!< I2C transactions executed successfully
+	uint32_t errors;				//!< I2C writes that failed. Queued writes that fail are retried.
+	uint32_t coalesced;				//!< Queued writes replaced by a newer write to the same register
+	uint32_t dropped;				//!< Writes discarded because the queue was full
+	uint32_t deferred;				//!< loop() calls that left writes queued because of the budget or high-priority work
+	uint32_t busTimeUs;				//!< Total time spent in I2C transactions in microseconds
+};
+
+/**
+ * @brief Schedules I2C traffic to the MAX7360 by priority
+ *
+ * Normally everything goes out to the chip in program order, so a burst of LED updates delays
+ * reading the key FIFO. With the scheduler:
+ *
+ * - URGENT priority reads and writes (FIFO drain, interrupt handling) go out immediately.
+ * - BEST_EFFORT and BACKGROUND writes are queued and sent from loop(), each class limited to a
+ * bus-time budget per loop() call. BEST_EFFORT is serviced before BACKGROUND.
+ * - If the /INTK pin is set and goes low, loop() stops sending queued writes so the key
+ * FIFO can be read first.
+ *
+ * BEST_EFFORT writes to a register that's already queued replace the older value, so a
+ * fast-changing LED only costs one write per loop(). BACKGROUND writes are never combined and
+ * are sent in the order they were queued.
+ *
+ * This only schedules traffic that goes through it. Traffic made directly on the MAX7360 object
+ * still goes out immediately.
+ */
+class MAX7360Scheduler {
+public:
+	/**
+	 * @brief Construct a scheduler
+	 *
+	 * @param chip The MAX7360 object
+	 *
+	 * @param intkPin The MCU pin connected to /INTK, or PIN_INVALID if not connected.
+	 */
+	MAX7360Scheduler(MAX7360 &chip, pin_t intkPin = PIN_INVALID);
+	virtual ~MAX7360Scheduler();
+
+	/**
+	 * @brief Set up the /INTK pin. Call from setup().
+	 */
+	void begin();
+
+	/**
+	 * @brief Sets the bus-time budget in microseconds per loop() call for a priority class
+	 *
+	 * Defaults are 1000 us for BEST_EFFORT and 500 us for BACKGROUND. At least one write is
+	 * sent per class per loop() (unless /INTK is asserted) so the queues always make progress.
+	 * The URGENT budget is ignored.
+	 */
+	MAX7360Scheduler &withBudgetUs(MAX7360Priority priority, uint32_t budgetUs);
+
+	/**
+	 * @brief Write a register at a priority
+	 *
+	 * @return For URGENT, the result of the write. For other classes, true if queued, false if the queue is full.
+	 */
+	bool writeRegister(MAX7360Priority priority, uint8_t reg, uint8_t value);
+
+	/**
+	 * @brief Read a register immediately (URGENT priority)
+	 */
+	uint8_t readRegister(uint8_t reg);
+
+	/**
+	 * @brief Read the key FIFO immediately (URGENT priority)
+	 */
+	MAX7360Key readKeyFIFO();
+
+	/**
+	 * @brief Read all keys in the FIFO immediately (URGENT priority)
+	 *
+	 * @param keys Array to store the keys in
+	 *
+	 * @param maxKeys Size of the keys array
+	 *
+	 * @return Number of keys stored
+	 */
+	size_t drainKeyFIFO(MAX7360Key *keys, size_t maxKeys);
+
+	/**
+	 * @brief Returns true if high-priority work is waiting (/INTK is asserted)
+	 */
+	bool isHighPriorityPending() const;
+
+	/**
+	 * @brief Call from loop() to send queued writes
+	 */
+	void loop();
+
+	/**
+	 * @brief Send all queued writes now, ignoring the budgets
+	 */
+	void flush();
+
+	/**
+	 * @brief Get statistics for a priority class
+	 */
+	const MAX7360SchedulerStats &getStats(MAX7360Priority priority) const { return classes[(size_t)priority].stats; };
+
+	/**
+	 * @brief Get the number of writes queued for a priority class
+	 */
+	size_t getQueueDepth(MAX7360Priority priority) const { return classes[(size_t)priority].count; };
+
+	/**
+	 * @brief Reset statistics for all classes (queue depth is left as-is)
+	 */
+	void resetStats();
+
+	static const size_t NUM_CLASSES = 3;		//!< Number of priority classes
+	static const size_t QUEUE_SIZE = 16;		//!< Maximum writes queued per class
+
+protected:
+	/**
+	 * @brief A queued register write
+	 */
+	struct QueuedWrite {
+		uint8_t reg;
+		uint8_t value;
+	};
+
+	/**
+	 * @brief Queue and statistics for one priority class
+	 */
+	struct PriorityClass {
+		QueuedWrite queue[QUEUE_SIZE];
+		size_t count;
+		uint32_t budgetUs;
+		MAX7360SchedulerStats stats;
+	};
+
+	/**
+	 * @brief Send queued writes for a class until the budget is used up
+	 *
+	 * Stops at the first write that fails and leaves it queued, so writes are never lost or
+	 * sent out of order.
+	 *
+	 * @return false if it stopped because high-priority work is pending
+	 */
+	bool service(PriorityClass &pc, bool ignoreBudget);
+
+	/**
+	 * @brief Account for a transaction that started at startUs
+	 *
+	 * @param success false if the transaction failed, counted in errors instead of transactions
+	 */
+	void account(PriorityClass &pc, unsigned long startUs, bool success = true);
+
+	MAX7360 &chip;
+	pin_t intkPin;
+	PriorityClass classes[NUM_CLASSES];
+};
+
+#endif /* __MAX7360SCHEDULER_H */
@@ -0,0 +1,185 @@
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+
+#include "MAX7360TextEntry.h"
+
+#if MAX7360_ENABLE_KEYPAD
+
+const char * const MAX7360TextEntry::defaultKeyCharacters[10] = {
+	" 0",		// 0
+	".-1",		// 1
+	"ABC2",		// 2
+	"DEF3",		// 3
+	"GHI4",		// 4
+	"JKL5",		// 5
+	"MNO6",		// 6
+	"PQRS7",	// 7
+	"TUV8",		// 8
+	"WXYZ9"		// 9
+};
+
+MAX7360TextEntry::MAX7360TextEntry(char *buffer, size_t bufferSize) : buffer(buffer), bufferSize(bufferSize) {
+	for(size_t ii = 0; ii < 10; ii++) {
+		keyCharacters[ii] = defaultKeyCharacters[ii];
+	}
+	if (!buffer) {
+		// No buffer, nothing can be entered and getText() returns ""
+		this->bufferSize = 0;
+	}
+	if (this->bufferSize > 0) {
+		buffer[0] = 0;
+	}
+}
+
+MAX7360TextEntry::~MAX7360TextEntry() {
+
+}
+
+MAX7360TextEntry &MAX7360TextEntry::withKeyCharacters(char key, const char *chars) {
+	if (key >= '0' && key <= '9') {
+		keyCharacters[key - '0'] = chars;
+
+		if (key == pendingKey) {
+			// The pending character may not exist in the new string
+			if (!chars || !chars[0]) {
+				pendingKey = 0;
+				changed = true;
+			}
+			else
+			if (pendingIndex >= strlen(chars)) {
+				pendingIndex = 0;
+				changed = true;
+			}
+		}
+	}
+	return *this;
+}
+
+bool MAX7360TextEntry::processKey(const MAX7360Key &key) {
+	if (!key.hasKey() || key.isReleased()) {
+		// Empty, overflow, repeat, and key release events are ignored
+		return false;
+	}
+	return processMappedKey(key.getMappedKey());
+}
+
+bool MAX7360TextEntry::processMappedKey(char key) {
+	if (key == 0) {
+		return false;
+	}
+
+	if (key == backspaceKey) {
+		if (pendingKey) {
+			// Backspace cancels the pending character first
+			pendingKey = 0;
+		}
+		else
+		if (length > 0) {
+			buffer[--length] = 0;
+		}
+		changed = true;
+		return true;
+	}
+
+	if (key == clearKey) {
+		clear();
+		return true;
+	}
+
+	if (key < '0' || key > '9') {
+		return false;
+	}
+
+	const char *chars = keyCharacters[key - '0'];
+	if (!chars || !chars[0]) {
+		return false;
+	}
+
+	if (key == pendingKey) {
+		// Same key again within the timeout, advance to the next character
+		if (chars[++pendingIndex] == 0) {
+			pendingIndex = 0;
+		}
+	}
+	else {
+		// Different key, commit the previous one and start a new character
+		commit();
+
+		if (length + 1 >= bufferSize) {
+			// Buffer is full
+			return false;
+		}
+		pendingKey = key;
+		pendingIndex = 0;
+	}
+	pendingTime = millis();
+	changed = true;
+
+	return true;
+}
+
+void MAX7360TextEntry::loop() {
+	if (pendingKey && millis() - pendingTime >= commitTimeoutMs) {
+		commit();
+	}
+}
+
+void MAX7360TextEntry::commit() {
+	char c = getPendingChar();
+	pendingKey = 0;
+
+	if (c && length + 1 < bufferSize) {
+		buffer[length++] = c;
+		buffer[length] = 0;
+		changed = true;
+	}
+}
+
+const char *MAX7360TextEntry::getText() const {
+	return (bufferSize > 0) ? buffer : "";
+}
+
+void MAX7360TextEntry::clear() {
+	pendingKey = 0;
+	length = 0;
+	if (bufferSize > 0) {
+		buffer[0] = 0;
+	}
+	changed = true;
+}
+
+char MAX7360TextEntry::getPendingChar() const {
+	if (!pendingKey) {
+		return 0;
+	}
+	const char *chars = keyCharacters[pendingKey - '0'];
+	if (!chars) {
+		return 0;
+	}
+	// Don't index past the end if the string was changed in place
+	for(size_t ii = 0; ii < pendingIndex; ii++) {
+		if (chars[ii] == 0) {
+			return 0;
+		}
+	}
+	return chars[pendingIndex];
+}
+
+unsigned long MAX7360TextEntry::getMsUntilCommit() const {
+	if (!pendingKey) {
+		return 0;
+	}
+	unsigned long elapsed = millis() - pendingTime;
+	if (elapsed >= commitTimeoutMs) {
+		return 0;
+	}
+	return commitTimeoutMs - elapsed;
+}
+
+bool MAX7360TextEntry::getChanged() {
+	bool result = changed;
+	changed = false;
+	return result;
+}
+
+#endif /* MAX7360_ENABLE_KEYPAD */
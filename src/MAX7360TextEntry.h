@@ -0,0 +1,158 @@
+#ifndef __MAX7360TEXTENTRY_H
+#define __MAX7360TEXTENTRY_H
+
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+
+#include "MAX7360-RK.h"
+
+#if MAX7360_ENABLE_KEYPAD
+
+/**
+ * @brief Multi-tap (phone-style) text entry on top of a phone keypad mapping
+ *
+ * Pressing the same key repeatedly within the timeout cycles through the letters for
+ * that key (2 = a, b, c, 2). When the timeout expires, or a different key is pressed,
+ * the pending character is committed to the buffer.
+ *
+ * This class does not allocate memory. You pass in the buffer to store the text in,
+ * normally a global or class member variable. The buffer is always null terminated.
+ *
+ * Typical use:
+ * - Call processKey() with each key returned by MAX7360::readKeyFIFO().
+ * - Call loop() from loop(). It only compares millis() against the commit deadline,
+ * it never blocks.
+ *
+ * The commit timeout is a millis() deadline checked by loop() rather than a software Timer.
+ * A Timer callback runs on the timer thread and would modify the buffer while your loop() code
+ * is reading it, so every access would need a lock, and each Timer uses a system timer and
+ * stack space. The deadline check costs one subtraction per loop(). If you sleep or block,
+ * use getMsUntilCommit() to wake up in time.
+ *
+ * Key release events are ignored, so it doesn't matter if you enable them or not.
+ */
+class MAX7360TextEntry {
+public:
+	/**
+	 * @brief Construct a text entry object
+	 *
+	 * @param buffer Buffer to store the text in. Must remain valid for the lifetime of this object.
+	 *
+	 * @param bufferSize Size of the buffer in bytes, including the null terminator. If 0 or buffer
+	 * is NULL, no text can be entered and getText() returns an empty string.
+	 */
+	MAX7360TextEntry(char *buffer, size_t bufferSize);
+	virtual ~MAX7360TextEntry();
+
+	/**
+	 * @brief Sets the time after the last press that the pending character is committed. Default: 1000 ms.
+	 */
+	MAX7360TextEntry &withCommitTimeoutMs(unsigned long ms) { commitTimeoutMs = ms; return *this; };
+
+	/**
+	 * @brief Sets the key that deletes the last character. Default: '*'. Use 0 for none.
+	 */
+	MAX7360TextEntry &withBackspaceKey(char key) { backspaceKey = key; return *this; };
+
+	/**
+	 * @brief Sets the key that clears the entire buffer. Default: '#'. Use 0 for none.
+	 */
+	MAX7360TextEntry &withClearKey(char key) { clearKey = key; return *this; };
+
+	/**
+	 * @brief Sets the characters to cycle through for a digit key
+	 *
+	 * @param key The digit key '0' - '9'
+	 *
+	 * @param chars The characters to cycle through, for example "ABC2". Must be a string constant
+	 * or otherwise remain valid; the pointer is stored, not a copy. Pass 0 to make the key do nothing.
+	 *
+	 * If a character from this key is pending, it's reset to the first character of the new string,
+	 * or discarded if the key now does nothing.
+	 */
+	MAX7360TextEntry &withKeyCharacters(char key, const char *chars);
+
+	/**
+	 * @brief Process a key read from the FIFO
+	 *
+	 * @return true if the key was used (the text or pending character changed), false if ignored.
+	 */
+	bool processKey(const MAX7360Key &key);
+
+	/**
+	 * @brief Process a mapped key character (as returned by MAX7360Key::getMappedKey())
+	 */
+	bool processMappedKey(char key);
+
+	/**
+	 * @brief Call from loop() to commit the pending character after the timeout
+	 */
+	void loop();
+
+	/**
+	 * @brief Commit the pending character now, if there is one
+	 */
+	void commit();
+
+	/**
+	 * @brief Clear the buffer and any pending character
+	 */
+	void clear();
+
+	/**
+	 * @brief Get the committed text (null terminated)
+	 */
+	const char *getText() const;
+
+	/**
+	 * @brief Get the length of the committed text in bytes (not including the null terminator)
+	 */
+	size_t getLength() const { return length; };
+
+	/**
+	 * @brief Returns the character currently being cycled, or 0 if there is none
+	 *
+	 * This has not been added to the buffer yet. You typically display it after getText()
+	 * with a cursor or highlight.
+	 */
+	char getPendingChar() const;
+
+	/**
+	 * @brief Returns true if there is a pending character that has not been committed
+	 */
+	bool hasPending() const { return pendingKey != 0; };
+
+	/**
+	 * @brief Returns the number of milliseconds until the pending character is committed, or 0 if none
+	 *
+	 * Useful if you want to sleep or wait on something else until the commit is due.
+	 */
+	unsigned long getMsUntilCommit() const;
+
+	/**
+	 * @brief Returns true if the text or pending character changed since the last call, then clears the flag
+	 */
+	bool getChanged();
+
+	/**
+	 * @brief Default characters for keys '0' - '9'
+	 */
+	static const char * const defaultKeyCharacters[10];
+
+protected:
+	char *buffer;
+	size_t bufferSize;
+	size_t length = 0;
+	const char *keyCharacters[10];
+	unsigned long commitTimeoutMs = 1000;
+	char backspaceKey = '*';
+	char clearKey = '#';
+	char pendingKey = 0;
+	uint8_t pendingIndex = 0;
+	unsigned long pendingTime = 0;
+	bool changed = false;
+};
+
+#endif /* MAX7360_ENABLE_KEYPAD */
+
+#endif /* __MAX7360TEXTENTRY_H */
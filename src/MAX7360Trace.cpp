@@ -0,0 +1,231 @@
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+
+#include "MAX7360Trace.h"
+
+#if MAX7360_ENABLE_INSTRUMENTATION
+
+MAX7360TraceRecorder::MAX7360TraceRecorder(uint8_t *buffer, size_t bufferSize) : buffer(buffer), bufferSize(bufferSize) {
+
+}
+
+MAX7360TraceRecorder::~MAX7360TraceRecorder() {
+
+}
+
+void MAX7360TraceRecorder::recordFifo(uint8_t rawValue, unsigned long timeMs) {
+	if (rawValue != MAX7360Key::FIFO_EMPTY) {
+		record(MAX7360TraceType::FIFO, rawValue, timeMs);
+	}
+}
+
+void MAX7360TraceRecorder::recordGpio(uint8_t inputs, unsigned long timeMs) {
+	if (!hasGpio || inputs != lastGpio) {
+		hasGpio = true;
+		lastGpio = inputs;
+		record(MAX7360TraceType::GPIO, inputs, timeMs);
+	}
+}
+
+void MAX7360TraceRecorder::recordRotary(int8_t delta, unsigned long timeMs) {
+	if (delta != 0) {
+		record(MAX7360TraceType::ROTARY, (uint8_t)delta, timeMs);
+	}
+}
+
+void MAX7360TraceRecorder::record(MAX7360TraceType type, uint8_t value, unsigned long timeMs) {
+	if (!enabled || bufferSize < MAX_RECORD_SIZE) {
+		return;
+	}
+
+	uint32_t delta;
+	if (used == 0 && dropCount == 0) {
+		// First record since clear
+		baseTimeMs = timeMs;
+		delta = 0;
+	}
+	else {
+		delta = timeMs - lastTimeMs;
+	}
+	lastTimeMs = timeMs;
+
+	// Encode
+	uint8_t rec[MAX_RECORD_SIZE];
+	size_t len = 0;
+	if (delta < DELTA_EXTENDED) {
+		rec[len++] = ((uint8_t)type << 6) | (uint8_t)delta;
+	}
+	else {
+		rec[len++] = ((uint8_t)type << 6) | DELTA_EXTENDED;
+		do {
+			uint8_t b = delta & 0x7f;
+			delta >>= 7;
+			if (delta) {
+				b |= 0x80;
+			}
+			rec[len++] = b;
+		} while(delta);
+	}
+	rec[len++] = value;
+
+	// Discard the oldest records to make room
+	while(bufferSize - used < len) {
+		uint32_t droppedDelta;
+		size_t droppedSize = decodeAt(0, droppedDelta);
+		readIndex = (readIndex + droppedSize) % bufferSize;
+		used -= droppedSize;
+		baseTimeMs += droppedDelta;
+		dropCount++;
+	}
+
+	for(size_t ii = 0; ii < len; ii++) {
+		buffer[(readIndex + used++) % bufferSize] = rec[ii];
+	}
+}
+
+void MAX7360TraceRecorder::clear() {
+	readIndex = used = 0;
+	dropCount = 0;
+	hasGpio = false;
+}
+
+size_t MAX7360TraceRecorder::exportTrace(uint8_t *out, size_t outSize) const {
+	if (outSize < getExportSize()) {
+		return 0;
+	}
+	getHeader(out);
+	for(size_t ii = 0; ii < used; ii++) {
+		out[HEADER_SIZE + ii] = byteAt(ii);
+	}
+	return getExportSize();
+}
+
+void MAX7360TraceRecorder::exportHex(Print &out) const {
+	uint8_t header[HEADER_SIZE];
+	getHeader(header);
+
+	size_t size = getExportSize();
+	for(size_t ii = 0; ii < size; ii++) {
+		uint8_t b = (ii < HEADER_SIZE) ? header[ii] : byteAt(ii - HEADER_SIZE);
+		out.printf("%02x", b);
+		if ((ii % 32) == 31 || ii == size - 1) {
+			out.println("");
+		}
+	}
+}
+
+size_t MAX7360TraceRecorder::decodeAt(size_t offset, uint32_t &delta) const {
+	size_t pos = offset;
+
+	delta = byteAt(pos++) & DELTA_MASK;
+	if (delta == DELTA_EXTENDED) {
+		delta = 0;
+		for(int shift = 0; ; shift += 7) {
+			uint8_t b = byteAt(pos++);
+			delta |= (uint32_t)(b & 0x7f) << shift;
+			if ((b & 0x80) == 0) {
+				break;
+			}
+		}
+	}
+	// Value byte
+	pos++;
+
+	return pos - offset;
+}
+
+void MAX7360TraceRecorder::getHeader(uint8_t *header) const {
+	header[0] = 'M';
+	header[1] = '7';
+	header[2] = 'T';
+	header[3] = FORMAT_VERSION;
+	header[4] = (uint8_t) baseTimeMs;
+	header[5] = (uint8_t) (baseTimeMs >> 8);
+	header[6] = (uint8_t) (baseTimeMs >> 16);
+	header[7] = (uint8_t) (baseTimeMs >> 24);
+}
+
+
+MAX7360TraceReplay::MAX7360TraceReplay(const uint8_t *data, size_t dataSize) : data(data), dataSize(dataSize) {
+	valid = (dataSize >= MAX7360TraceRecorder::HEADER_SIZE &&
+		data[0] == 'M' && data[1] == '7' && data[2] == 'T' &&
+		data[3] == MAX7360TraceRecorder::FORMAT_VERSION);
+	rewind();
+}
+
+MAX7360TraceReplay::~MAX7360TraceReplay() {
+
+}
+
+void MAX7360TraceReplay::rewind() {
+	offset = MAX7360TraceRecorder::HEADER_SIZE;
+	if (valid) {
+		timeMs = (unsigned long)data[4] | ((unsigned long)data[5] << 8) | ((unsigned long)data[6] << 16) | ((unsigned long)data[7] << 24);
+	}
+}
+
+bool MAX7360TraceReplay::next(MAX7360TraceRecord &record) {
+	if (!valid || offset >= dataSize) {
+		return false;
+	}
+
+	uint8_t tag = data[offset++];
+	if ((tag >> 6) > (uint8_t) MAX7360TraceType::ROTARY) {
+		// Not a record type the recorder writes, the data is corrupt
+		offset = dataSize;
+		return false;
+	}
+	uint32_t delta = tag & MAX7360TraceRecorder::DELTA_MASK;
+	if (delta == MAX7360TraceRecorder::DELTA_EXTENDED) {
+		delta = 0;
+		for(int shift = 0; ; shift += 7) {
+			if (offset >= dataSize || shift > 28) {
+				// Truncated or corrupt
+				offset = dataSize;
+				return false;
+			}
+			uint8_t b = data[offset++];
+			delta |= (uint32_t)(b & 0x7f) << shift;
+			if ((b & 0x80) == 0) {
+				break;
+			}
+		}
+	}
+	if (offset >= dataSize) {
+		return false;
+	}
+	timeMs += delta;
+
+	record.type = (MAX7360TraceType)(tag >> 6);
+	record.value = data[offset++];
+	record.timeMs = timeMs;
+
+	return true;
+}
+
+size_t MAX7360TraceReplay::replay(MAX7360TraceReplayHandler handler, void *context, bool realTime) {
+	size_t count = 0;
+	unsigned long startMillis = millis();
+	unsigned long firstTimeMs = 0;
+
+	MAX7360TraceRecord record;
+	while(next(record)) {
+		if (count == 0) {
+			firstTimeMs = record.timeMs;
+		}
+		if (realTime) {
+			unsigned long elapsed = millis() - startMillis;
+			unsigned long target = record.timeMs - firstTimeMs;
+			if (target > elapsed) {
+				delay(target - elapsed);
+			}
+		}
+
+		MAX7360Key key(keyMapping, (record.type == MAX7360TraceType::FIFO) ? record.value : MAX7360Key::FIFO_EMPTY);
+		handler(record, key, context);
+		count++;
+	}
+	return count;
+}
+
+#endif /* MAX7360_ENABLE_INSTRUMENTATION */
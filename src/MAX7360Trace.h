@@ -0,0 +1,233 @@
+#ifndef __MAX7360TRACE_H
+#define __MAX7360TRACE_H
+
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+
+#include "MAX7360-RK.h"
+
+#if MAX7360_ENABLE_INSTRUMENTATION
+
+/**
+ * @brief Type of a trace record
+ */
+enum class MAX7360TraceType : uint8_t {
+	FIFO = 0,			//!< Raw byte read from the key FIFO (REG_KEYS_FIFO)
+	GPIO = 1,			//!< GPIO input snapshot (REG_GPIO_INPUT)
+	ROTARY = 2			//!< Rotary switch delta (REG_GPIO_ROTARY_SWITCH_COUNT)
+};
+
+/**
+ * @brief One decoded trace record
+ */
+struct MAX7360TraceRecord {
+	MAX7360TraceType type;		//!< What was read
+	uint8_t value;				//!< The raw byte read. For ROTARY, cast to int8_t for the signed delta.
+	unsigned long timeMs;		//!< millis() value when it was read
+};
+
+/**
+ * @brief Records FIFO, GPIO, and rotary activity in a compact binary format
+ *
+ * Attach it using MAX7360::withTraceRecorder() and every non-empty FIFO read, changed GPIO
+ * input value, and non-zero rotary delta is recorded automatically. You can also call the
+ * record methods directly.
+ *
+ * Records are stored in a buffer you pass in, which is used as a ring buffer: when it fills
+ * up, the oldest records are discarded. No memory is allocated.
+ *
+ * Each record is a tag byte followed by a value byte. The top 2 bits of the tag are the
+ * MAX7360TraceType and the low 6 bits are milliseconds since the previous record. If the delta
+ * is 63 ms or more, the low 6 bits are 63 and the delta follows as a varint (7 bits per
+ * byte, LSB first, high bit set if more bytes follow) before the value byte. Most records
+ * are 2 bytes.
+ *
+ * The exported format is a 8-byte header ('M', '7', 'T', version, base time as uint32_t
+ * little endian) followed by the records, oldest first. The first record's delta is
+ * relative to the base time.
+ */
+class MAX7360TraceRecorder {
+public:
+	/**
+	 * @brief Construct a trace recorder
+	 *
+	 * @param buffer Buffer to store records in. Must remain valid for the lifetime of this object.
+	 *
+	 * @param bufferSize Size of the buffer in bytes
+	 */
+	MAX7360TraceRecorder(uint8_t *buffer, size_t bufferSize);
+	virtual ~MAX7360TraceRecorder();
+
+	/**
+	 * @brief Record a raw FIFO byte. FIFO_EMPTY is not recorded.
+	 */
+	void recordFifo(uint8_t rawValue) { recordFifo(rawValue, millis()); };
+	void recordFifo(uint8_t rawValue, unsigned long timeMs);
+
+	/**
+	 * @brief Record a GPIO input snapshot. Only recorded if it differs from the last one.
+	 */
+	void recordGpio(uint8_t inputs) { recordGpio(inputs, millis()); };
+	void recordGpio(uint8_t inputs, unsigned long timeMs);
+
+	/**
+	 * @brief Record a rotary switch delta. Zero is not recorded.
+	 */
+	void recordRotary(int8_t delta) { recordRotary(delta, millis()); };
+	void recordRotary(int8_t delta, unsigned long timeMs);
+
+	/**
+	 * @brief Record a value. The other record methods call this.
+	 */
+	void record(MAX7360TraceType type, uint8_t value, unsigned long timeMs);
+
+	/**
+	 * @brief Pause or resume recording
+	 */
+	void setEnabled(bool enabled) { this->enabled = enabled; };
+
+	/**
+	 * @brief Discard all records
+	 */
+	void clear();
+
+	/**
+	 * @brief Number of bytes exportTrace() needs
+	 */
+	size_t getExportSize() const { return HEADER_SIZE + used; };
+
+	/**
+	 * @brief Number of records discarded because the buffer was full
+	 */
+	uint32_t getDropCount() const { return dropCount; };
+
+	/**
+	 * @brief Copy the trace to a buffer in the exported format
+	 *
+	 * @return Number of bytes copied, or 0 if outSize is smaller than getExportSize()
+	 */
+	size_t exportTrace(uint8_t *out, size_t outSize) const;
+
+	/**
+	 * @brief Write the trace in the exported format as hex, 32 bytes per line
+	 */
+	void exportHex(Print &out) const;
+
+	static const size_t HEADER_SIZE = 8;		//!< Size of the export header in bytes
+	static const uint8_t FORMAT_VERSION = 1;	//!< Version byte in the export header
+	static const uint8_t DELTA_MASK = 0x3f;		//!< Tag byte delta mask (low 6 bits)
+	static const uint8_t DELTA_EXTENDED = 0x3f;	//!< Tag byte delta value indicating a varint delta follows
+	static const size_t MAX_RECORD_SIZE = 7;	//!< Tag, up to 5 varint bytes, value
+
+protected:
+	/**
+	 * @brief Decode the record at offset in the ring buffer
+	 *
+	 * @return Size of the record in bytes
+	 */
+	size_t decodeAt(size_t offset, uint32_t &delta) const;
+
+	/**
+	 * @brief Byte at offset from the oldest record, wrapping around the ring buffer
+	 */
+	uint8_t byteAt(size_t offset) const { return buffer[(readIndex + offset) % bufferSize]; };
+
+	/**
+	 * @brief Fill in the 8-byte export header
+	 */
+	void getHeader(uint8_t *header) const;
+
+	uint8_t *buffer;
+	size_t bufferSize;
+	size_t readIndex = 0;
+	size_t used = 0;
+	unsigned long baseTimeMs = 0;
+	unsigned long lastTimeMs = 0;
+	uint32_t dropCount = 0;
+	uint8_t lastGpio = 0;
+	bool hasGpio = false;
+	bool enabled = true;
+};
+
+/**
+ * @brief Handler called for each record during replay
+ *
+ * @param record The decoded record
+ *
+ * @param key For FIFO records, the key decoded using MAX7360Key::fromRawValue(). For other
+ * record types, an empty key.
+ *
+ * @param context The context pointer passed to replay()
+ */
+typedef void (*MAX7360TraceReplayHandler)(const MAX7360TraceRecord &record, const MAX7360Key &key, void *context);
+
+/**
+ * @brief Plays back a trace exported by MAX7360TraceRecorder
+ *
+ * Each FIFO record is decoded with MAX7360Key::fromRawValue() and passed to your handler with
+ * its recorded time, which you can pass to the higher-level layers (for example,
+ * MAX7360GestureRecognizer::processKey(key, record.timeMs)) for regression or throughput testing.
+ *
+ * This class only uses millis() and delay() so it also runs on a host build with a Particle
+ * API shim.
+ */
+class MAX7360TraceReplay {
+public:
+	/**
+	 * @brief Construct a replay object from an exported trace
+	 *
+	 * @param data The exported trace. Must remain valid for the lifetime of this object.
+	 *
+	 * @param dataSize Size in bytes
+	 */
+	MAX7360TraceReplay(const uint8_t *data, size_t dataSize);
+	virtual ~MAX7360TraceReplay();
+
+	/**
+	 * @brief Sets the key mapping object to use for decoded keys
+	 */
+	MAX7360TraceReplay &withKeyMapping(MAX7360KeyMappingBase *keyMapping) { this->keyMapping = keyMapping; return *this; };
+
+	/**
+	 * @brief Returns true if the data has a valid header
+	 */
+	bool isValid() const { return valid; };
+
+	/**
+	 * @brief Go back to the first record
+	 */
+	void rewind();
+
+	/**
+	 * @brief Decode the next record
+	 *
+	 * @return true if a record was decoded, false at the end of the trace or if the data is invalid.
+	 * An unknown record type or a truncated record ends the replay.
+	 */
+	bool next(MAX7360TraceRecord &record);
+
+	/**
+	 * @brief Replay all records from the current position
+	 *
+	 * @param handler Called for each record
+	 *
+	 * @param context Passed to handler
+	 *
+	 * @param realTime true to replay at recorded speed (blocks using delay()), false to replay as fast as possible
+	 *
+	 * @return Number of records replayed
+	 */
+	size_t replay(MAX7360TraceReplayHandler handler, void *context = 0, bool realTime = false);
+
+protected:
+	const uint8_t *data;
+	size_t dataSize;
+	size_t offset = 0;
+	unsigned long timeMs = 0;
+	bool valid = false;
+	MAX7360KeyMappingBase *keyMapping = 0;
+};
+
+#endif /* MAX7360_ENABLE_INSTRUMENTATION */
+
+#endif /* __MAX7360TRACE_H */
@@ -0,0 +1,217 @@
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+//
+// Host implementation of the Particle API shim in Particle.h
+
+#include "Particle.h"
+
+#include <stdarg.h>
+#include <chrono>
+#include <thread>
+
+uint8_t hostRegisters[256];
+bool hostLogEnabled = false;
+
+static const uint8_t FIFO_EMPTY = 0x3f;
+static const size_t FIFO_SIZE = 16;
+
+static uint8_t fifo[FIFO_SIZE];
+static size_t fifoCount = 0;
+
+static uint8_t regPtr = 0;
+static uint8_t txBuf[32];
+static size_t txCount = 0;
+static uint8_t rxBuf[32];
+static size_t rxCount = 0;
+static size_t rxIndex = 0;
+
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+unsigned long millis() {
+	return (unsigned long) std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+unsigned long micros() {
+	return (unsigned long) std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void delay(unsigned long ms) {
+	std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us) {
+	std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void pinMode(pin_t pin, int mode) {
+}
+
+int digitalRead(pin_t pin) {
+	return HIGH;
+}
+
+void digitalWrite(pin_t pin, int value) {
+}
+
+bool attachInterrupt(pin_t pin, void (*handler)(void), int mode) {
+	return true;
+}
+
+void detachInterrupt(pin_t pin) {
+}
+
+size_t Print::printf(const char *fmt, ...) {
+	va_list ap;
+	va_start(ap, fmt);
+	int count = vprintf(fmt, ap);
+	va_end(ap);
+	return (count > 0) ? (size_t) count : 0;
+}
+
+size_t Print::print(const char *str) {
+	return fputs(str, stdout) >= 0 ? strlen(str) : 0;
+}
+
+size_t Print::println(const char *str) {
+	return print(str) + print("\n");
+}
+
+size_t Print::write(uint8_t b) {
+	return fputc(b, stdout) == EOF ? 0 : 1;
+}
+
+bool USBSerial::isConnected() {
+	return true;
+}
+
+void hostQueueFifo(uint8_t rawValue) {
+	if (fifoCount < FIFO_SIZE) {
+		fifo[fifoCount++] = rawValue;
+	}
+}
+
+static uint8_t readSimulatedRegister() {
+	if (regPtr == 0) {
+		// Key FIFO: doesn't auto-increment
+		if (fifoCount == 0) {
+			return FIFO_EMPTY;
+		}
+		uint8_t value = fifo[0];
+		memmove(&fifo[0], &fifo[1], --fifoCount);
+		return value;
+	}
+	return hostRegisters[regPtr++];
+}
+
+void TwoWire::setSpeed(uint32_t speed) {
+}
+
+void TwoWire::begin() {
+}
+
+void TwoWire::end() {
+}
+
+bool TwoWire::isEnabled() {
+	return true;
+}
+
+void TwoWire::beginTransmission(uint8_t addr) {
+	txCount = 0;
+}
+
+uint8_t TwoWire::endTransmission(bool stop) {
+	if (txCount > 0) {
+		regPtr = txBuf[0];
+		for(size_t ii = 1; ii < txCount; ii++) {
+			hostRegisters[regPtr++] = txBuf[ii];
+		}
+	}
+	return 0;
+}
+
+size_t TwoWire::write(uint8_t b) {
+	if (txCount >= sizeof(txBuf)) {
+		return 0;
+	}
+	txBuf[txCount++] = b;
+	return 1;
+}
+
+size_t TwoWire::write(const uint8_t *buf, size_t count) {
+	size_t ii;
+	for(ii = 0; ii < count && write(buf[ii]); ii++) {
+	}
+	return ii;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t addr, uint8_t count, uint8_t stop) {
+	if (count > sizeof(rxBuf)) {
+		count = sizeof(rxBuf);
+	}
+	for(size_t ii = 0; ii < count; ii++) {
+		rxBuf[ii] = readSimulatedRegister();
+	}
+	rxCount = count;
+	rxIndex = 0;
+	return count;
+}
+
+int TwoWire::read() {
+	return (rxIndex < rxCount) ? rxBuf[rxIndex++] : -1;
+}
+
+int TwoWire::available() {
+	return (int)(rxCount - rxIndex);
+}
+
+bool TwoWire::lock() {
+	return true;
+}
+
+bool TwoWire::unlock() {
+	return true;
+}
+
+TwoWire Wire;
+TwoWire Wire1;
+
+static void logMessage(const char *level, const char *fmt, va_list ap) {
+	if (hostLogEnabled) {
+		fprintf(stderr, "%s: ", level);
+		vfprintf(stderr, fmt, ap);
+		fputc('\n', stderr);
+	}
+}
+
+void Logger::trace(const char *fmt, ...) {
+	va_list ap;
+	va_start(ap, fmt);
+	logMessage("TRACE", fmt, ap);
+	va_end(ap);
+}
+
+void Logger::info(const char *fmt, ...) {
+	va_list ap;
+	va_start(ap, fmt);
+	logMessage("INFO", fmt, ap);
+	va_end(ap);
+}
+
+void Logger::warn(const char *fmt, ...) {
+	va_list ap;
+	va_start(ap, fmt);
+	logMessage("WARN", fmt, ap);
+	va_end(ap);
+}
+
+void Logger::error(const char *fmt, ...) {
+	va_list ap;
+	va_start(ap, fmt);
+	logMessage("ERROR", fmt, ap);
+	va_end(ap);
+}
+
+Logger Log;
+USBSerial Serial;
+SystemClass System;
@@ -0,0 +1,158 @@
+#ifndef __PARTICLE_HOST_SHIM_H
+#define __PARTICLE_HOST_SHIM_H
+
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+//
+// Minimal Particle Device OS API for compiling and running the library on a host computer
+// (Linux, macOS) with g++ or clang++. It only declares what the library uses. It is not a
+// complete or accurate emulation of Device OS and is not used in device builds.
+//
+// - millis() and micros() come from the host's monotonic clock and delay() sleeps.
+// - Wire talks to a simulated MAX7360 whose registers are plain memory, with auto-increment.
+//   Reading register 0x00 (the key FIFO) returns keys queued with hostQueueFifo(), then
+//   FIFO_EMPTY.
+// - GPIO, interrupts, and sleep do nothing. digitalRead() always returns HIGH.
+// - Log messages are printed to stderr if hostLogEnabled is true.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+
+typedef uint16_t pin_t;
+
+#define PIN_INVALID 0xff
+
+#define D0 0
+#define D1 1
+#define D2 2
+#define D3 3
+#define D4 4
+#define D5 5
+#define D6 6
+#define D7 7
+
+#define HIGH 1
+#define LOW 0
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+typedef enum PinMode {
+	INPUT,
+	OUTPUT,
+	INPUT_PULLUP,
+	INPUT_PULLDOWN
+} PinMode;
+
+#define CLOCK_SPEED_100KHZ 100000
+#define CLOCK_SPEED_400KHZ 400000
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(pin_t pin, int mode);
+int digitalRead(pin_t pin);
+void digitalWrite(pin_t pin, int value);
+bool attachInterrupt(pin_t pin, void (*handler)(void), int mode);
+void detachInterrupt(pin_t pin);
+
+class Print {
+public:
+	size_t printf(const char *fmt, ...);
+	size_t print(const char *str);
+	size_t println(const char *str);
+	size_t write(uint8_t b);
+};
+
+class TwoWire {
+public:
+	void setSpeed(uint32_t speed);
+	void begin();
+	void end();
+	bool isEnabled();
+	void beginTransmission(uint8_t addr);
+	uint8_t endTransmission(bool stop = true);
+	size_t write(uint8_t b);
+	size_t write(const uint8_t *buf, size_t count);
+	uint8_t requestFrom(uint8_t addr, uint8_t count, uint8_t stop);
+	int read();
+	int available();
+	bool lock();
+	bool unlock();
+};
+extern TwoWire Wire;
+extern TwoWire Wire1;
+
+class Logger {
+public:
+	void trace(const char *fmt, ...);
+	void info(const char *fmt, ...);
+	void warn(const char *fmt, ...);
+	void error(const char *fmt, ...);
+};
+extern Logger Log;
+
+#define LOG_LEVEL_ALL 1
+#define LOG_LEVEL_TRACE 1
+#define LOG_LEVEL_INFO 30
+
+class SerialLogHandler {
+public:
+	SerialLogHandler(int level = LOG_LEVEL_INFO) {};
+};
+
+class USBSerial : public Print {
+public:
+	bool isConnected();
+};
+extern USBSerial Serial;
+
+enum class SystemSleepMode {
+	STOP,
+	ULTRA_LOW_POWER
+};
+
+class SystemSleepConfiguration {
+public:
+	SystemSleepConfiguration &mode(SystemSleepMode mode) { return *this; };
+	SystemSleepConfiguration &gpio(pin_t pin, int mode) { return *this; };
+	SystemSleepConfiguration &duration(unsigned long ms) { return *this; };
+};
+
+class SystemSleepResult {
+public:
+	int wakeupReason() { return 0; };
+};
+
+class SystemClass {
+public:
+	SystemSleepResult sleep(const SystemSleepConfiguration &config) { return SystemSleepResult(); };
+	uint64_t millis() { return ::millis(); };
+};
+extern SystemClass System;
+
+#define SYSTEM_THREAD(x)
+#define SYSTEM_MODE(x)
+#define waitFor(condition, timeoutMs)
+
+/**
+ * @brief Simulated MAX7360 registers, for host programs to set up or inspect
+ */
+extern uint8_t hostRegisters[256];
+
+/**
+ * @brief Queue a raw byte to be returned by the next read of the key FIFO (register 0x00)
+ */
+void hostQueueFifo(uint8_t rawValue);
+
+/**
+ * @brief Print Log messages to stderr (default: false)
+ */
+extern bool hostLogEnabled;
+
+#endif /* __PARTICLE_HOST_SHIM_H */
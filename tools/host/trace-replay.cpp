@@ -0,0 +1,179 @@
+// Repository: https://github.com/rickkas7/MAX7360-RK
+// License: MIT
+//
+// Replays a trace exported by MAX7360TraceRecorder on the host, printing each record and the
+// gestures MAX7360GestureRecognizer finds in it. Use it to check how a change to the
+// gesture timing or the library handles a trace captured on a device.
+//
+//   trace-replay [--realtime] [--long-press MS] [--double-tap MS] FILE
+//
+// FILE is either the binary output of exportTrace() or the hex output of exportHex().
+// Build with make -C tools/host.
+
+#include "Particle.h"
+#include "MAX7360Trace.h"
+#include "MAX7360GestureRecognizer.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <vector>
+
+static const char *gestureName(MAX7360GestureType type) {
+	switch(type) {
+	case MAX7360GestureType::TAP:
+		return "TAP";
+	case MAX7360GestureType::DOUBLE_TAP:
+		return "DOUBLE_TAP";
+	case MAX7360GestureType::LONG_PRESS:
+		return "LONG_PRESS";
+	case MAX7360GestureType::HOLD_REPEAT:
+		return "HOLD_REPEAT";
+	case MAX7360GestureType::CHORD_RELEASE:
+		return "CHORD_RELEASE";
+	}
+	return "?";
+}
+
+static void printGestures(MAX7360GestureRecognizer &gestures) {
+	MAX7360GestureEvent event;
+	while(gestures.getEvent(event)) {
+		printf("%10lu  gesture %-13s key=%u", event.timeMs, gestureName(event.type), event.rawKey);
+		if (event.type == MAX7360GestureType::HOLD_REPEAT) {
+			printf(" repeat=%u", event.repeatCount);
+		}
+		if (event.type == MAX7360GestureType::CHORD_RELEASE) {
+			printf(" chord=0x%016llx", (unsigned long long) event.chordMask);
+		}
+		printf("\n");
+	}
+}
+
+static void handler(const MAX7360TraceRecord &record, const MAX7360Key &key, void *context) {
+	MAX7360GestureRecognizer &gestures = *(MAX7360GestureRecognizer *)context;
+
+	switch(record.type) {
+	case MAX7360TraceType::FIFO:
+		if (key.isOverflow()) {
+			printf("%10lu  fifo    0x%02x overflow\n", record.timeMs, record.value);
+		}
+		else
+		if (key.isKeyRepeat()) {
+			printf("%10lu  fifo    0x%02x repeat count=%u\n", record.timeMs, record.value, key.getRepeatCount());
+		}
+		else {
+			printf("%10lu  fifo    0x%02x key=%u %s\n", record.timeMs, record.value, key.getRawKey(), key.isReleased() ? "released" : "pressed");
+		}
+		gestures.processKey(key, record.timeMs);
+		break;
+
+	case MAX7360TraceType::GPIO:
+		printf("%10lu  gpio    0x%02x\n", record.timeMs, record.value);
+		gestures.loop(record.timeMs);
+		break;
+
+	case MAX7360TraceType::ROTARY:
+		printf("%10lu  rotary  %d\n", record.timeMs, (int8_t) record.value);
+		gestures.loop(record.timeMs);
+		break;
+	}
+	printGestures(gestures);
+}
+
+static bool readTrace(const char *path, std::vector<uint8_t> &data) {
+	FILE *fp = fopen(path, "rb");
+	if (!fp) {
+		return false;
+	}
+	std::vector<uint8_t> raw;
+	int c;
+	while((c = fgetc(fp)) != EOF) {
+		raw.push_back((uint8_t) c);
+	}
+	fclose(fp);
+
+	// Binary traces start with the 'M', '7', 'T' header. Otherwise decode as hex.
+	if (raw.size() >= 3 && raw[0] == 'M' && raw[1] == '7' && raw[2] == 'T') {
+		data = raw;
+		return true;
+	}
+
+	int nibble = -1;
+	for(uint8_t ch : raw) {
+		if (isspace(ch)) {
+			continue;
+		}
+		if (!isxdigit(ch)) {
+			return false;
+		}
+		int value = isdigit(ch) ? (ch - '0') : (tolower(ch) - 'a' + 10);
+		if (nibble < 0) {
+			nibble = value;
+		}
+		else {
+			data.push_back((uint8_t)((nibble << 4) | value));
+			nibble = -1;
+		}
+	}
+	return nibble < 0;
+}
+
+static void usage() {
+	fprintf(stderr, "usage: trace-replay [--realtime] [--long-press MS] [--double-tap MS] FILE\n");
+	exit(2);
+}
+
+int main(int argc, char *argv[]) {
+	bool realTime = false;
+	unsigned long longPressMs = 0;
+	unsigned long doubleTapMs = 0;
+	const char *path = 0;
+
+	for(int ii = 1; ii < argc; ii++) {
+		if (strcmp(argv[ii], "--realtime") == 0) {
+			realTime = true;
+		}
+		else
+		if (strcmp(argv[ii], "--long-press") == 0 && ii + 1 < argc) {
+			longPressMs = strtoul(argv[++ii], 0, 10);
+		}
+		else
+		if (strcmp(argv[ii], "--double-tap") == 0 && ii + 1 < argc) {
+			doubleTapMs = strtoul(argv[++ii], 0, 10);
+		}
+		else
+		if (argv[ii][0] != '-' && !path) {
+			path = argv[ii];
+		}
+		else {
+			usage();
+		}
+	}
+	if (!path) {
+		usage();
+	}
+
+	std::vector<uint8_t> data;
+	if (!readTrace(path, data)) {
+		fprintf(stderr, "could not read trace %s\n", path);
+		return 1;
+	}
+
+	MAX7360TraceReplay replay(data.data(), data.size());
+	if (!replay.isValid()) {
+		fprintf(stderr, "%s is not a MAX7360 trace\n", path);
+		return 1;
+	}
+
+	MAX7360GestureRecognizer gestures;
+	if (longPressMs) {
+		gestures.withLongPressMs(longPressMs);
+	}
+	if (doubleTapMs) {
+		gestures.withDoubleTapMs(doubleTapMs);
+	}
+
+	size_t count = replay.replay(handler, &gestures, realTime);
+
+	printf("%lu records\n", (unsigned long) count);
+	return 0;
+}
@@ -0,0 +1,235 @@
+#!/bin/bash
+# Repository: https://github.com/rickkas7/MAX7360-RK
+# License: MIT
+#
+# Reports the flash and RAM cost of each MAX7360_ENABLE_* feature (see src/MAX7360Config.h).
+#
+# Compiler mode (default) compiles every file in src with all features enabled, then again with
+# each feature disabled, and prints the text (flash), data, and bss (RAM) totals of the objects
+# from the size utility. This is the most the library can add to a build; the linker drops
+# functions your application never calls.
+#
+#   tools/size-report.sh [--shim DIR | --no-shim] [--cxx COMPILER] [--size SIZE] [--cflags FLAGS]
+#
+#   --shim DIR      Directory with the Particle.h to compile against. Default: tools/host, the
+#                   Particle API shim in this repository.
+#   --no-shim       Don't add a Particle.h directory; pass the Device OS include flags in --cflags
+#   --cxx COMPILER  Default: arm-none-eabi-g++ if it's in the PATH, otherwise g++
+#   --size SIZE     Default: arm-none-eabi-size or size, to match the compiler
+#   --cflags FLAGS  Extra compiler flags. Default for arm-none-eabi-g++: -mcpu=cortex-m4 -mthumb
+#
+# Particle mode builds a small application that uses every enabled feature, once per
+# configuration, with the Particle CLI cloud compiler, and prints the size of the binary
+# (flash only, the cloud compiler doesn't return the ELF file).
+#
+#   tools/size-report.sh --particle PLATFORM
+#
+# The cloud compiler doesn't take compiler flags, so each configuration is built from a copy of
+# the library with the defaults in MAX7360Config.h changed.
+#
+# The object sizes include the key mapping classes' vtables (MAX7360KeyMappingBase and, with
+# KEYPAD, MAX7360KeyMappingTable and MAX7360KeyMappingPhone). They are kept virtual so
+# applications can supply their own mapping. The linker only keeps a vtable if the application
+# constructs a mapping object of that class, so an application without a key mapping doesn't pay
+# for them even though they appear here.
+
+set -e
+
+FEATURES="KEYPAD GPIO LED ROTARY INSTRUMENTATION"
+
+LIBDIR="$(cd "$(dirname "$0")/.." && pwd)"
+
+SHIM="$LIBDIR/tools/host"
+CXX=""
+SIZE=""
+CFLAGS=""
+PLATFORM=""
+
+while [ $# -gt 0 ]; do
+	case "$1" in
+		--shim) SHIM="$2"; shift 2 ;;
+		--no-shim) SHIM=""; shift ;;
+		--cxx) CXX="$2"; shift 2 ;;
+		--size) SIZE="$2"; shift 2 ;;
+		--cflags) CFLAGS="$2"; shift 2 ;;
+		--particle) PLATFORM="$2"; shift 2 ;;
+		*) echo "unknown option $1"; exit 1 ;;
+	esac
+done
+
+TMPDIR="$(mktemp -d)"
+trap 'rm -rf "$TMPDIR"' EXIT
+
+# Prints the -D flags that disable the feature $1 (or nothing for "all")
+defines_for() {
+	if [ "$1" != "all" ]; then
+		echo "-DMAX7360_ENABLE_$1=0"
+	fi
+}
+
+# Prints "text data bss" for a compiler mode configuration
+compile_config() {
+	local config="$1"
+	local objdir="$TMPDIR/$config"
+	mkdir -p "$objdir"
+
+	for src in "$LIBDIR"/src/*.cpp; do
+		$CXX -std=gnu++14 -Os -w -ffunction-sections -fdata-sections -fno-exceptions -fno-rtti \
+			$CFLAGS ${SHIM:+-I"$SHIM"} -I"$LIBDIR/src" $(defines_for "$config") \
+			-c "$src" -o "$objdir/$(basename "$src" .cpp).o"
+	done
+
+	$SIZE -t "$objdir"/*.o | tail -1 | awk '{ print $1, $2, $3 }'
+}
+
+# Writes an application that uses each enabled feature to $1/src/app.cpp
+write_app() {
+	mkdir -p "$1/src"
+	cat > "$1/src/app.cpp" <<'EOF'
+#include "MAX7360-RK.h"
+#include "MAX7360TextEntry.h"
+#include "MAX7360KeyDispatcher.h"
+#include "MAX7360GestureRecognizer.h"
+#include "MAX7360GhostFilter.h"
+#include "MAX7360GpioExpander.h"
+#include "MAX7360Color.h"
+#include "MAX7360FadeEngine.h"
+#include "MAX7360Trace.h"
+#include "MAX7360Latency.h"
+
+MAX7360 chip;
+
+#if MAX7360_ENABLE_KEYPAD
+MAX7360KeyMappingPhone keyMapping;
+MAX7360KeyDispatcher dispatcher(&keyMapping);
+char textBuffer[32];
+MAX7360TextEntry textEntry(textBuffer, sizeof(textBuffer));
+MAX7360GestureRecognizer gestures;
+MAX7360GhostFilter ghostFilter(4, 3);
+#endif
+#if MAX7360_ENABLE_GPIO
+MAX7360GpioExpander gpio(chip);
+#endif
+#if MAX7360_ENABLE_LED
+MAX7360RGBLed rgbLed(chip);
+MAX7360FadeEngine fadeEngine(chip);
+#endif
+#if MAX7360_ENABLE_INSTRUMENTATION
+uint8_t traceBuffer[256];
+MAX7360TraceRecorder traceRecorder(traceBuffer, sizeof(traceBuffer));
+MAX7360LatencyMonitor latencyMonitor;
+#endif
+
+void setup() {
+	chip.begin();
+#if MAX7360_ENABLE_KEYPAD
+	chip.withKeyMapping(&keyMapping).withRepeatCoalescing();
+	chip.configureForKeyMapping();
+#endif
+#if MAX7360_ENABLE_GPIO
+	gpio.begin();
+	chip.writeGpoOutputs(MAX7360::GPO_COL7_MASK, 0);
+#endif
+#if MAX7360_ENABLE_ROTARY
+	chip.setConfigRotaryEncoder();
+#endif
+#if MAX7360_ENABLE_INSTRUMENTATION
+	chip.withTraceRecorder(&traceRecorder);
+	latencyMonitor.begin(chip, D2);
+#endif
+}
+
+void loop() {
+	MAX7360Key key = chip.readKeyFIFO();
+#if MAX7360_ENABLE_KEYPAD
+	if (ghostFilter.accept(key)) {
+		dispatcher.dispatch(key);
+		textEntry.processKey(key);
+		gestures.processKey(key);
+	}
+	textEntry.loop();
+	gestures.loop();
+#endif
+#if MAX7360_ENABLE_GPIO
+	gpio.digitalWrite(0, gpio.digitalRead(1));
+	gpio.flush();
+#endif
+#if MAX7360_ENABLE_LED
+	rgbLed.setHSV((uint8_t)(millis() / 10), 255, 255);
+	fadeEngine.loop();
+#endif
+#if MAX7360_ENABLE_ROTARY
+	chip.readRotarySwitchCount();
+#endif
+#if MAX7360_ENABLE_INSTRUMENTATION
+	latencyMonitor.markConsumed();
+#endif
+}
+EOF
+}
+
+# Prints the size of the binary for a Particle mode configuration
+particle_config() {
+	local config="$1"
+	local projdir="$TMPDIR/$config"
+
+	write_app "$projdir"
+	mkdir -p "$projdir/lib/MAX7360-RK"
+	cp -r "$LIBDIR/src" "$LIBDIR/library.properties" "$projdir/lib/MAX7360-RK/"
+	if [ "$config" != "all" ]; then
+		sed -i.bak "s/^#define MAX7360_ENABLE_$config 1/#define MAX7360_ENABLE_$config 0/" "$projdir/lib/MAX7360-RK/src/MAX7360Config.h"
+		rm -f "$projdir/lib/MAX7360-RK/src/MAX7360Config.h.bak"
+	fi
+	echo "name=size-report" > "$projdir/project.properties"
+
+	particle compile "$PLATFORM" "$projdir" --saveTo "$projdir/app.bin" > "$projdir/compile.log" 2>&1 || {
+		cat "$projdir/compile.log" >&2
+		exit 1
+	}
+	wc -c < "$projdir/app.bin" | tr -d ' '
+}
+
+if [ -n "$PLATFORM" ]; then
+	echo "Particle $PLATFORM application binary size (bytes)"
+	printf "%-24s %8s %8s\n" "configuration" "flash" "saved"
+
+	full=$(particle_config all)
+	printf "%-24s %8s %8s\n" "all features" "$full" "-"
+	for feature in $FEATURES; do
+		flash=$(particle_config "$feature")
+		printf "%-24s %8s %8s\n" "without $feature" "$flash" "$((full - flash))"
+	done
+	exit 0
+fi
+
+if [ -z "$CXX" ]; then
+	if command -v arm-none-eabi-g++ > /dev/null; then
+		CXX=arm-none-eabi-g++
+		CFLAGS="${CFLAGS:--mcpu=cortex-m4 -mthumb}"
+	else
+		CXX=g++
+	fi
+fi
+if [ -z "$SIZE" ]; then
+	case "$CXX" in
+		arm-none-eabi-*) SIZE=arm-none-eabi-size ;;
+		*) SIZE=size ;;
+	esac
+fi
+
+echo "Library object size with $CXX (bytes)"
+printf "%-24s %8s %8s %8s %8s %8s\n" "configuration" "text" "data" "bss" "flash" "ram"
+
+read -r fullText fullData fullBss <<< "$(compile_config all)"
+printf "%-24s %8s %8s %8s %8s %8s\n" "all features" "$fullText" "$fullData" "$fullBss" "$((fullText + fullData))" "$((fullData + fullBss))"
+
+for feature in $FEATURES; do
+	read -r text data bss <<< "$(compile_config "$feature")"
+	printf "%-24s %8s %8s %8s %8s %8s\n" "cost of $feature" \
+		"$((fullText - text))" "$((fullData - data))" "$((fullBss - bss))" \
+		"$((fullText + fullData - text - data))" "$((fullData + fullBss - data - bss))"
+done
+
+echo
+echo "Per file, all features"
+$SIZE "$TMPDIR/all"/*.o | awk 'NR > 1 { n = split($6, p, "/"); printf "%-32s %8s %8s %8s\n", p[n], $1, $2, $3 }'